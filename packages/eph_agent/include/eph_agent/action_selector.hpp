@@ -2,36 +2,195 @@
 #define EPH_AGENT_ACTION_SELECTOR_HPP
 
 #include <Eigen/Core>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
 #include "eph_core/types.hpp"
 #include "eph_core/constants.hpp"
 #include "eph_core/math_utils.hpp"
+#include "eph_spm/channel_set.hpp"
 #include "eph_spm/saliency_polar_map.hpp"
+#include "eph_spm/polar_grid.hpp"
+#include "eph_agent/candidate_lattice.hpp"
+#include "eph_agent/efe_terms.hpp"
 
 namespace eph::agent {
 
+/**
+ * @brief 行為選択の方式
+ */
+enum class SelectionMode {
+    Gradient,    // EFE勾配降下（select_action()、既定）
+    Sampling,    // 候補サンプリング（select_action_sampled()、CandidateLattice の M 候補から最小 EFE）
+    LineSearch   // 反復勾配降下 + Armijo直線探索（select_action_line_search()）
+};
+
+/**
+ * @brief 反復勾配降下（直線探索）の設定
+ *
+ * 1ステップ η = LEARNING_RATE の固定ステップの代わりに、1回の行為選択の中で
+ * G の最小点まで反復する。各反復は η0 から ρ 倍ずつ縮めて Armijo 条件
+ * G(v') ≤ G(v) + c·∇G·(v' - v) を満たすステップを探す。
+ */
+struct DescentOptions {
+    int max_iterations = 20;                        // 反復上限
+    Scalar gradient_tolerance = 1e-4;               // (射影)勾配ノルムの許容値（以下で終了）
+    Scalar initial_step = constants::LEARNING_RATE; // 初期ステップ η0
+    Scalar armijo = 1e-4;                           // Armijo 条件の係数 c
+    Scalar backtrack = 0.5;                         // ステップ縮小率 ρ
+    int max_backtracks = 30;                        // 1反復あたりの縮小回数の上限
+};
+
+/**
+ * @brief 行為選択の計算量（監視用）
+ */
+struct SolverStats {
+    int iterations = 1;   // 受理した勾配ステップ数（固定ステップ・候補サンプリングは 1）
+    int evaluations = 0;  // 直線探索での G の評価回数
+};
+
+/**
+ * @brief EFEの内訳 G = Epistemic + Pragmatic
+ */
+struct EfeTerms {
+    Scalar epistemic = 0.0;  // Epistemic項の和（既定: ⟨h⟩ · ⟨|∇SPM|⟩）
+    Scalar pragmatic = 0.0;  // Pragmatic項の和（既定: κ(fatigue) · |v|）
+
+    auto total() const -> Scalar { return epistemic + pragmatic; }
+};
+
+/**
+ * @brief 行為選択の結果（新しい速度と EFE の内訳）
+ *
+ * EFE はいずれの方式でも返した速度での G(v_new)。
+ */
+struct ActionSelection {
+    Vec2 velocity;      // 新しい速度 [m/s]
+    EfeTerms efe;       // EFE の内訳
+    SolverStats stats;  // 計算量
+};
+
+/**
+ * @brief 全エージェントの行為選択入力（SoA: 配列構造体）
+ *
+ * ActionSelector::select_action_batch() が vx, vy をその場で更新する。
+ * 行為選択の入力は速度・疲労度と、Pragmatic項がSPM・Hazeから読む文脈量 context
+ * （エージェント × BasicActionSelector::kContextSize、各行は compute_context()）。
+ * EFE の Pragmatic項は更新後の速度で評価して pragmatic に書き出す。
+ * Epistemic項 epistemic（ActionSelector::compute_epistemic()）は候補サンプリングで
+ * 候補の G = Epistemic + Pragmatic を比べるための入力（勾配降下では読まない）。
+ */
+struct ActionBatch {
+    using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+
+    Array vx;         // 速度 x [m/s]（入出力）
+    Array vy;         // 速度 y [m/s]（入出力）
+    Array fatigue;    // 疲労度 [0, 1]
+    Array epistemic;  // EFE Epistemic項（候補サンプリングの入力）
+    Array pragmatic;  // EFE Pragmatic項（出力、更新後の速度で評価）
+    Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic> context;  // Pragmatic項の文脈量（エージェント × 文脈量）
+
+    void resize(Eigen::Index n, Eigen::Index context_size = 0) {
+        vx.resize(n);
+        vy.resize(n);
+        fatigue.resize(n);
+        epistemic.resize(n);
+        pragmatic.resize(n);
+        context.resize(n, context_size);
+    }
+
+    auto size() const -> Eigen::Index { return vx.size(); }
+};
+
 /**
  * @brief 行為選択クラス（Phase 4: Expected Free Energy勾配降下）
  *
  * ## Expected Free Energy (EFE)
+ * G(v) = Σ Epistemic項 + Σ Pragmatic項
+ *
+ * 項はテンプレート引数 Terms... で与える（efe_terms.hpp のポリシー）。各項が値と
+ * 解析勾配を持ち、項の並びはコンパイル時に展開して1つのカーネルに融合する
+ * （エージェントごとの内側ループに仮想関数呼び出しはない）。既定構成 ActionSelector は
+ *
  * G(v) = ⟨h⟩ · ⟨|∇SPM|⟩ + κ(fatigue) · |v|
  *        ↑ Epistemic      ↑ Pragmatic
  *
- * - **Epistemic項**: Haze × 環境勾配（不確実性駆動探索）
- * - **Pragmatic項**: 疲労 × 速度（エネルギーコスト）
+ * - **Epistemic項**（efe::HazeSaliency）: Haze × 環境勾配（不確実性駆動探索）
+ *   （⟨·⟩ は視野内ビンの平均。死角ビンは知覚されないため含めない）
+ * - **Pragmatic項**（efe::FatigueCost）: 疲労 × 速度（エネルギーコスト）
  *
  * ## 勾配降下
  * v_new = v_old - η · ∇_v G(v)
  *
  * - η = LEARNING_RATE
- * - ∇_v G: 中心差分による数値微分
+ * - ∇_v G: 解析勾配（Epistemic項は v に依存しないので Pragmatic項の勾配の和。
+ *   既定構成では ∇_v G = κ(fatigue) · v/|v|）
  * - 制約: |v| ∈ [V_MIN, V_MAX]
+ *
+ * Pragmatic項がSPM・Hazeから読む量（文脈量、compute_context()）は速度によらないため
+ * エージェントごとに1回だけ求め、勾配はその値から解析的に計算する。勾配1回あたり
+ * compute_efe() 4回分の評価が不要になる。
+ * 中心差分による数値微分（compute_efe_gradient_fd()）は検証用に残す。
+ * set_gradient_verification(true) の間、select_action() は従来どおり中心差分で
+ * 速度を更新し（数値微分で較正した結果をビット単位で再現）、解析勾配との差を
+ * gradient_verification_report() に集計する。
+ *
+ * SPM引数は SaliencyPolarMap と SpmBatch のエージェントビューのどちらも受け付ける
+ * （channel() / gradient_magnitude_mean() を持つ型）。
+ *
+ * spm_level を指定すると ⟨|∇SPM|⟩ を多重解像度ピラミッドの段 spm_level
+ * （0: 12×12, 1: 6×6, 2: 3×3）で評価する。遠方・低重要度のエージェント向け。
+ *
+ * ## 候補サンプリング（SelectionMode::Sampling）
+ * 勾配は局所的な傾きしか追えないため、速度空間の大域探索として
+ * CandidateLattice の M 候補（極座標格子 + 摂動、進行方向に回転）で
+ * G = Epistemic + Pragmatic（文脈量を通してSPMと結合する項を含む）を一括評価し、
+ * 最小の候補を選ぶ（select_action_sampled()）。候補の評価は M 要素の配列演算、
+ * 群全体では M × エージェントの2次元配列演算（select_action_sampled_batch()）。
+ * 予算 M は CandidateLattice の方向数 × 速さの段数。
+ *
+ * 読むSPMチャネルは kReadChannels（各項の読むチャネルの和、既定構成では F2）のみ。
+ *
+ * @tparam Terms EFEの項（Epistemic項・Pragmatic項を任意の順で。Pragmatic項は1つ以上）
  */
-class ActionSelector {
+template <typename... Terms>
+class BasicActionSelector {
 public:
     using Scalar = eph::Scalar;
     using Vec2 = eph::Vec2;
     using Matrix12x12 = eph::Matrix12x12;
 
+    static_assert((Terms::kVelocityDependent || ...),
+                  "Action selection needs at least one velocity-dependent (pragmatic) EFE term");
+
+    // 行為選択が読むSPMチャネル
+    static constexpr spm::ChannelMask kReadChannels = (spm::kNoChannels | ... | Terms::kReadChannels);
+
+    // Pragmatic項の文脈量の数（項の並び順に連結）
+    static constexpr int kContextSize = (0 + ... + efe::context_size<Terms>());
+
+    // 1エージェントの文脈量（compute_context()）
+    using Context = Eigen::Array<Scalar, kContextSize, 1>;
+
+    /**
+     * @brief 解析勾配と数値微分の比較結果（1回分）
+     */
+    struct GradientCheck {
+        Vec2 analytic;           // 解析勾配
+        Vec2 finite_difference;  // 中心差分
+        Scalar max_abs_error;    // 成分ごとの差の最大値
+    };
+
+    /**
+     * @brief 検証スイッチ有効中の集計
+     */
+    struct GradientVerificationReport {
+        std::uint64_t samples;   // 比較した select_action() の回数
+        Scalar max_abs_error;    // 差の最大値
+    };
+
     /**
      * @brief 行為選択（EFE勾配降下）
      *
@@ -39,50 +198,208 @@ public:
      * @param haze 現在のHazeフィールド [0, 1]
      * @param spm Saliency Polar Map
      * @param fatigue 疲労度 [0, 1]
+     * @param spm_level ⟨|∇SPM|⟩ を評価するピラミッド段（0 = 元の解像度）
      * @return 新しい速度 [m/s]（[V_MIN, V_MAX]にクリップ済み）
      */
+    template <typename SpmT>
     static auto select_action(
         const Vec2& current_velocity,
         const Matrix12x12& haze,
-        const spm::SaliencyPolarMap& spm,
-        Scalar fatigue
+        const SpmT& spm,
+        Scalar fatigue,
+        int spm_level = 0
     ) -> Vec2;
 
+    /**
+     * @brief 行為選択と EFE の内訳
+     *
+     * 速度は select_action() と同一。EFE は返す速度での値 G(v_new)（候補サンプリング・
+     * 直線探索と同じ）。Epistemic項は v に依存しないので G(v_current) と同じ値で、
+     * ⟨|∇SPM|⟩ はSPM側で書き込み時に確定した値を読む。
+     *
+     * @return 新しい速度と G(v_new) の内訳
+     */
+    template <typename SpmT>
+    static auto select_action_with_efe(
+        const Vec2& current_velocity,
+        const Matrix12x12& haze,
+        const SpmT& spm,
+        Scalar fatigue,
+        int spm_level = 0
+    ) -> ActionSelection;
+
+    /**
+     * @brief 行為選択（候補サンプリング）
+     *
+     * lattice の候補から G(v) = Epistemic + Pragmatic が最小の速度を選ぶ（同値なら先頭の候補）。
+     * 高疲労（>0.8）では apply_constraints() と同じく強制休息（v=0）。
+     *
+     * @param current_velocity 現在の速度 [m/s]（候補を回転させる進行方向。静止時は +x）
+     * @param haze 現在のHazeフィールド [0, 1]
+     * @param spm Saliency Polar Map
+     * @param fatigue 疲労度 [0, 1]
+     * @param lattice 速度候補
+     * @param spm_level ⟨|∇SPM|⟩ を評価するピラミッド段
+     * @return 選んだ速度と G(v_new) の内訳
+     */
+    template <typename SpmT>
+    static auto select_action_sampled(
+        const Vec2& current_velocity,
+        const Matrix12x12& haze,
+        const SpmT& spm,
+        Scalar fatigue,
+        const CandidateLattice& lattice,
+        int spm_level = 0
+    ) -> ActionSelection;
+
+    /**
+     * @brief 行為選択（反復勾配降下 + Armijo直線探索）
+     *
+     * 速度を制約集合に射影してから（apply_constraints()）、射影勾配法で反復する:
+     * v' = P(v - η∇G)、η は options.initial_step から Armijo 条件を満たすまで縮小。
+     * 次のいずれかで終了する。
+     * - ‖∇G‖ ≤ tol、または ‖v' - v‖/η ≤ tol（制約境界上の停留点）
+     * - 反復数が max_iterations に達した
+     * - max_backtracks 回縮小しても Armijo 条件を満たさない
+     *
+     * Epistemic項は v に依存しないため、直線探索では Pragmatic項のみ評価する
+     * （文脈量は反復の前に1回だけ求める）。
+     *
+     * @param options 反復・直線探索の設定
+     * @return 新しい速度、G(v_new) の内訳、反復数と G の評価回数
+     */
+    template <typename SpmT>
+    static auto select_action_line_search(
+        const Vec2& current_velocity,
+        const Matrix12x12& haze,
+        const SpmT& spm,
+        Scalar fatigue,
+        const DescentOptions& options,
+        int spm_level = 0
+    ) -> ActionSelection;
+
     // === 以下のメソッドはテスト可能性のためpublic ===
     /**
-     * @brief EFE計算: G(v) = ⟨h⟩·⟨|∇SPM|⟩ + κ·|v|
+     * @brief EFE計算: G(v) = Σ Epistemic項 + Σ Pragmatic項
      *
      * @param velocity 速度ベクトル
      * @param haze Hazeフィールド
      * @param spm Saliency Polar Map
      * @param fatigue 疲労度 [0, 1]
+     * @param spm_level ⟨|∇SPM|⟩ を評価するピラミッド段
      * @return Expected Free Energy
      */
+    template <typename SpmT>
     static auto compute_efe(
         const Vec2& velocity,
         const Matrix12x12& haze,
-        const spm::SaliencyPolarMap& spm,
-        Scalar fatigue
+        const SpmT& spm,
+        Scalar fatigue,
+        int spm_level = 0
     ) -> Scalar;
 
     /**
-     * @brief EFE勾配計算（中心差分）
+     * @brief EFEの内訳（compute_efe() = compute_efe_terms().total()）
+     */
+    template <typename SpmT>
+    static auto compute_efe_terms(
+        const Vec2& velocity,
+        const Matrix12x12& haze,
+        const SpmT& spm,
+        Scalar fatigue,
+        int spm_level = 0
+    ) -> EfeTerms;
+
+    /**
+     * @brief Epistemic項の和（速度に依存しない。既定構成では ⟨h⟩·⟨|∇SPM|⟩）
+     */
+    template <typename SpmT>
+    static auto compute_epistemic(
+        const Matrix12x12& haze,
+        const SpmT& spm,
+        int spm_level = 0
+    ) -> Scalar;
+
+    /**
+     * @brief Pragmatic項の文脈量（速度に依存しない。ActionBatch::context の1行）
      *
-     * ∇_v G = [(G(v+εx) - G(v-εx))/(2ε), (G(v+εy) - G(v-εy))/(2ε)]
+     * 各 Pragmatic項の context() を項の並び順に連結する（既定構成では空）。
+     */
+    template <typename SpmT>
+    static auto compute_context(
+        const Matrix12x12& haze,
+        const SpmT& spm,
+        int spm_level = 0
+    ) -> Context;
+
+    /**
+     * @brief EFE勾配計算（解析解）
+     *
+     * ∇_v G = Σ Pragmatic項の勾配（Epistemic項は v に依存しない。既定構成では κ(fatigue) · v/|v|）
+     * SPM・Hazeは文脈量（compute_context()）として1回だけ読む。
+     * |v| < EPS では劣勾配 0 を返す。
      *
      * @param velocity 現在の速度
      * @param haze Hazeフィールド
      * @param spm Saliency Polar Map
      * @param fatigue 疲労度
+     * @param spm_level ピラミッド段
      * @return EFE勾配ベクトル
      */
+    template <typename SpmT>
     static auto compute_efe_gradient(
         const Vec2& velocity,
         const Matrix12x12& haze,
-        const spm::SaliencyPolarMap& spm,
-        Scalar fatigue
+        const SpmT& spm,
+        Scalar fatigue,
+        int spm_level = 0
+    ) -> Vec2;
+
+    /**
+     * @brief EFE勾配計算（中心差分、検証用）
+     *
+     * ∇_v G = [(G(v+εx) - G(v-εx))/(2ε), (G(v+εy) - G(v-εy))/(2ε)]
+     *
+     * |v| < ε では |v| の折れ目を平滑化するため解析勾配と一致しない。
+     *
+     * @param velocity 現在の速度
+     * @param haze Hazeフィールド
+     * @param spm Saliency Polar Map
+     * @param fatigue 疲労度
+     * @param spm_level ⟨|∇SPM|⟩ を評価するピラミッド段
+     * @return EFE勾配ベクトル
+     */
+    template <typename SpmT>
+    static auto compute_efe_gradient_fd(
+        const Vec2& velocity,
+        const Matrix12x12& haze,
+        const SpmT& spm,
+        Scalar fatigue,
+        int spm_level = 0
     ) -> Vec2;
 
+    /**
+     * @brief 解析勾配と中心差分を比較
+     */
+    template <typename SpmT>
+    static auto check_efe_gradient(
+        const Vec2& velocity,
+        const Matrix12x12& haze,
+        const SpmT& spm,
+        Scalar fatigue,
+        int spm_level = 0
+    ) -> GradientCheck;
+
+    /**
+     * @brief 勾配検証スイッチ（既定 off）
+     *
+     * 有効化すると集計をリセットし、以後の select_action() は中心差分で速度を更新しつつ
+     * check_efe_gradient() の差を集計する。全スレッド共通。
+     */
+    static void set_gradient_verification(bool enabled);
+    static auto gradient_verification() -> bool;
+    static auto gradient_verification_report() -> GradientVerificationReport;
+
     /**
      * @brief 速度制約適用
      *
@@ -96,36 +413,237 @@ public:
      * @return 制約適用後の速度
      */
     static auto apply_constraints(const Vec2& velocity, Scalar fatigue) -> Vec2;
+
+    /**
+     * @brief 全エージェントの行為選択（SoA、分岐なしSIMD）
+     *
+     * select_action()（検証スイッチ無効時）と同じ演算を、分岐を select() に置き換えて
+     * 配列全体に適用する。結果は select_action() とビット単位で一致する（単精度でも。
+     * 配列の sqrt は std::sqrt と同じく正しく丸める: EIGEN_FAST_MATH=0、eph_core/types.hpp）。
+     * 併せて pragmatic に更新後の速度での Pragmatic項を書き込む。
+     * 一時配列は kBatchBlock 要素のブロック単位でスタック上に取る（L1に収まる）。
+     *
+     * @param batch vx, vy（入出力）と fatigue, context
+     */
+    static void select_action_batch(ActionBatch& batch);
+
+    /**
+     * @brief 全エージェントの行為選択（候補サンプリング、SoA）
+     *
+     * kSampleBlock エージェントずつ、全候補 × エージェントの G を2次元配列で一括評価し、
+     * 列ごとに最小の候補を選ぶ。要素ごとの演算は select_action_sampled() と同じで、
+     * 結果はビット単位で一致する。vx, vy を選んだ速度、pragmatic を選んだ候補の
+     * Pragmatic項で上書きする。
+     *
+     * @param batch vx, vy（入出力）と fatigue, epistemic, context
+     * @param lattice 速度候補
+     */
+    static void select_action_sampled_batch(ActionBatch& batch, const CandidateLattice& lattice);
+
+    // 強制休息の疲労度しきい値（判定は resting()）
+    static constexpr Scalar kRestFatigue = 0.8;
+
+    /**
+     * @brief 強制休息の判定（スカラー・Eigen 配列共通）
+     *
+     * しきい値ちょうどの疲労度（一定量ずつ増減した結果）が丸め誤差で休息側に
+     * 入らないよう、constants::THRESHOLD_MARGIN だけ上で判定する。全経路で共通。
+     */
+    template <typename F>
+    static auto resting(const F& fatigue) {
+        return fatigue > kRestFatigue + constants::THRESHOLD_MARGIN;
+    }
+
+    // select_action_batch() のブロック長
+    static constexpr int kBatchBlock = 256;
+
+    // select_action_sampled_batch() のブロック長（エージェント数。M × kSampleBlock の配列で評価）
+    static constexpr int kSampleBlock = 32;
+
+private:
+    inline static std::atomic<bool> verify_gradient_{false};
+    inline static std::atomic<std::uint64_t> verified_samples_{0};
+    inline static std::atomic<Scalar> verified_max_error_{0.0};
+
+    static void record_gradient_check(const GradientCheck& check);
+
+    /**
+     * @brief 条件に合う項の和（Terms の並び順に加算、該当なしは 0）
+     *
+     * op(Term{}, offset) が各項の値（スカラーまたは Eigen 配列式）を返す。
+     * offset はその項の文脈量の先頭位置（std::integral_constant<int, ...>）。
+     * 項が1つなら加算を挟まず、その項の値そのものになる。
+     */
+    template <bool VelocityDependent, typename Op>
+    static auto sum_terms(const Op& op) {
+        return sum_terms_impl<VelocityDependent, 0, Terms...>(op);
+    }
+
+    template <bool VelocityDependent, int Offset, typename T, typename... Rest, typename Op>
+    static auto sum_terms_impl(const Op& op) {
+        constexpr bool take = T::kVelocityDependent == VelocityDependent;
+        constexpr bool rest = ((Rest::kVelocityDependent == VelocityDependent) || ... || false);
+        constexpr int next = Offset + efe::context_size<T>();
+        const std::integral_constant<int, Offset> offset;
+        if constexpr (take && rest) {
+            return op(T{}, offset) + sum_terms_impl<VelocityDependent, next, Rest...>(op);
+        } else if constexpr (take) {
+            return op(T{}, offset);
+        } else if constexpr (rest) {
+            return sum_terms_impl<VelocityDependent, next, Rest...>(op);
+        } else {
+            return Scalar(0.0);
+        }
+    }
+
+    // 各項の context() を文脈量の Offset 番目から書き込む
+    template <int Offset, typename T, typename... Rest, typename SpmT>
+    static void fill_context(const Matrix12x12& haze, const SpmT& spm, int spm_level, Context& context) {
+        if constexpr (efe::context_size<T>() > 0) {
+            context.template segment<T::kContextSize>(Offset) = T::context(haze, spm, spm_level);
+        }
+        if constexpr (sizeof...(Rest) > 0) {
+            fill_context<Offset + efe::context_size<T>(), Rest...>(haze, spm, spm_level, context);
+        }
+    }
+
+    // Pragmatic項の和とその解析勾配（1エージェント）
+    static auto pragmatic_value(const Context& context, const Vec2& velocity, Scalar fatigue) -> Scalar;
+    static auto pragmatic_gradient(const Context& context, const Vec2& velocity, Scalar fatigue) -> Vec2;
+
+    // 候補評価の本体: 最小 EFE の候補速度を返し、その Pragmatic項を pragmatic に書く
+    static auto best_candidate(
+        const Vec2& current_velocity,
+        Scalar epistemic,
+        const Context& context,
+        Scalar fatigue,
+        const CandidateLattice& lattice,
+        Scalar& pragmatic
+    ) -> Vec2;
 };
 
 // === 実装（ヘッダーオンリー） ===
 
-inline auto ActionSelector::compute_efe(
+template <typename... Terms>
+template <typename SpmT>
+inline auto BasicActionSelector<Terms...>::compute_efe(
+    const Vec2& velocity,
+    const Matrix12x12& haze,
+    const SpmT& spm,
+    Scalar fatigue,
+    int spm_level
+) -> Scalar {
+    return compute_efe_terms(velocity, haze, spm, fatigue, spm_level).total();
+}
+
+template <typename... Terms>
+template <typename SpmT>
+inline auto BasicActionSelector<Terms...>::compute_efe_terms(
     const Vec2& velocity,
     const Matrix12x12& haze,
-    const spm::SaliencyPolarMap& spm,
+    const SpmT& spm,
+    Scalar fatigue,
+    int spm_level
+) -> EfeTerms {
+    EfeTerms terms;
+
+    // Epistemic項（v に依存しない）
+    terms.epistemic = compute_epistemic(haze, spm, spm_level);
+
+    // Pragmatic項（v・疲労度・文脈量）
+    terms.pragmatic = pragmatic_value(compute_context(haze, spm, spm_level), velocity, fatigue);
+
+    return terms;
+}
+
+template <typename... Terms>
+inline auto BasicActionSelector<Terms...>::pragmatic_value(
+    const Context& context,
+    const Vec2& velocity,
     Scalar fatigue
 ) -> Scalar {
+    const Scalar speed = velocity.norm();
+    return sum_terms<true>([&](auto term, auto offset) {
+        const auto ctx = [&](int k) { return context(offset + k); };
+        return decltype(term)::value(ctx, fatigue, velocity.x(), velocity.y(), speed);
+    });
+}
+
+template <typename... Terms>
+inline auto BasicActionSelector<Terms...>::pragmatic_gradient(
+    const Context& context,
+    const Vec2& velocity,
+    Scalar fatigue
+) -> Vec2 {
     using namespace eph::constants;
 
-    // Epistemic項: ⟨h⟩ · ⟨|∇SPM|⟩
-    Scalar avg_haze = haze.mean();
-    auto grad_mag = spm.gradient_magnitude(eph::ChannelID::F2);  // F2 = Saliency
-    Scalar avg_grad = grad_mag.mean();
-    Scalar epistemic = avg_haze * avg_grad;
+    // 原点では劣勾配 0
+    const Scalar v_mag = velocity.norm();
+    if (v_mag < EPS) {
+        return Vec2::Zero();
+    }
+    const Scalar vx = velocity.x();
+    const Scalar vy = velocity.y();
+    return Vec2(
+        sum_terms<true>([&](auto term, auto offset) {
+            const auto ctx = [&](int k) { return context(offset + k); };
+            return decltype(term)::gradient_x(ctx, fatigue, vx, vy, v_mag);
+        }),
+        sum_terms<true>([&](auto term, auto offset) {
+            const auto ctx = [&](int k) { return context(offset + k); };
+            return decltype(term)::gradient_y(ctx, fatigue, vx, vy, v_mag);
+        })
+    );
+}
 
-    // Pragmatic項: κ(fatigue) · |v|
-    Scalar kappa_fatigue = 1.0 + 5.0 * fatigue;  // 疲労が高い → コスト増
-    Scalar pragmatic = kappa_fatigue * velocity.norm();
+template <typename... Terms>
+template <typename SpmT>
+inline auto BasicActionSelector<Terms...>::compute_epistemic(
+    const Matrix12x12& haze,
+    const SpmT& spm,
+    int spm_level
+) -> Scalar {
+    // SPM由来の量はSPM側で書き込み時に確定している（4回の差分評価で再計算しない）
+    return sum_terms<false>([&](auto term, auto) -> Scalar {
+        return decltype(term)::value(haze, spm, spm_level);
+    });
+}
 
-    return epistemic + pragmatic;
+template <typename... Terms>
+template <typename SpmT>
+inline auto BasicActionSelector<Terms...>::compute_context(
+    const Matrix12x12& haze,
+    const SpmT& spm,
+    int spm_level
+) -> Context {
+    Context context;
+    if constexpr (kContextSize > 0) {
+        fill_context<0, Terms...>(haze, spm, spm_level, context);
+    }
+    return context;
 }
 
-inline auto ActionSelector::compute_efe_gradient(
+template <typename... Terms>
+template <typename SpmT>
+inline auto BasicActionSelector<Terms...>::compute_efe_gradient(
     const Vec2& velocity,
     const Matrix12x12& haze,
-    const spm::SaliencyPolarMap& spm,
-    Scalar fatigue
+    const SpmT& spm,
+    Scalar fatigue,
+    int spm_level
+) -> Vec2 {
+    // Pragmatic項の解析勾配の和（Epistemic項は v に依存しない）
+    return pragmatic_gradient(compute_context(haze, spm, spm_level), velocity, fatigue);
+}
+
+template <typename... Terms>
+template <typename SpmT>
+inline auto BasicActionSelector<Terms...>::compute_efe_gradient_fd(
+    const Vec2& velocity,
+    const Matrix12x12& haze,
+    const SpmT& spm,
+    Scalar fatigue,
+    int spm_level
 ) -> Vec2 {
     using namespace eph::constants;
 
@@ -134,21 +652,66 @@ inline auto ActionSelector::compute_efe_gradient(
     // x方向の微分（中心差分）
     Vec2 v_plus_x = velocity + Vec2(GRADIENT_EPSILON, 0.0);
     Vec2 v_minus_x = velocity - Vec2(GRADIENT_EPSILON, 0.0);
-    Scalar efe_plus_x = compute_efe(v_plus_x, haze, spm, fatigue);
-    Scalar efe_minus_x = compute_efe(v_minus_x, haze, spm, fatigue);
-    gradient.x() = (efe_plus_x - efe_minus_x) / (2.0 * GRADIENT_EPSILON);
+    Scalar efe_plus_x = compute_efe(v_plus_x, haze, spm, fatigue, spm_level);
+    Scalar efe_minus_x = compute_efe(v_minus_x, haze, spm, fatigue, spm_level);
+    gradient.x() = (efe_plus_x - efe_minus_x) / (Scalar(2.0) * GRADIENT_EPSILON);
 
     // y方向の微分
     Vec2 v_plus_y = velocity + Vec2(0.0, GRADIENT_EPSILON);
     Vec2 v_minus_y = velocity - Vec2(0.0, GRADIENT_EPSILON);
-    Scalar efe_plus_y = compute_efe(v_plus_y, haze, spm, fatigue);
-    Scalar efe_minus_y = compute_efe(v_minus_y, haze, spm, fatigue);
-    gradient.y() = (efe_plus_y - efe_minus_y) / (2.0 * GRADIENT_EPSILON);
+    Scalar efe_plus_y = compute_efe(v_plus_y, haze, spm, fatigue, spm_level);
+    Scalar efe_minus_y = compute_efe(v_minus_y, haze, spm, fatigue, spm_level);
+    gradient.y() = (efe_plus_y - efe_minus_y) / (Scalar(2.0) * GRADIENT_EPSILON);
 
     return gradient;
 }
 
-inline auto ActionSelector::apply_constraints(
+template <typename... Terms>
+template <typename SpmT>
+inline auto BasicActionSelector<Terms...>::check_efe_gradient(
+    const Vec2& velocity,
+    const Matrix12x12& haze,
+    const SpmT& spm,
+    Scalar fatigue,
+    int spm_level
+) -> GradientCheck {
+    GradientCheck check;
+    check.analytic = compute_efe_gradient(velocity, haze, spm, fatigue, spm_level);
+    check.finite_difference = compute_efe_gradient_fd(velocity, haze, spm, fatigue, spm_level);
+    check.max_abs_error = (check.analytic - check.finite_difference).cwiseAbs().maxCoeff();
+    return check;
+}
+
+template <typename... Terms>
+inline void BasicActionSelector<Terms...>::set_gradient_verification(bool enabled) {
+    if (enabled) {
+        verified_samples_.store(0);
+        verified_max_error_.store(0.0);
+    }
+    verify_gradient_.store(enabled);
+}
+
+template <typename... Terms>
+inline auto BasicActionSelector<Terms...>::gradient_verification() -> bool {
+    return verify_gradient_.load(std::memory_order_relaxed);
+}
+
+template <typename... Terms>
+inline auto BasicActionSelector<Terms...>::gradient_verification_report() -> GradientVerificationReport {
+    return {verified_samples_.load(), verified_max_error_.load()};
+}
+
+template <typename... Terms>
+inline void BasicActionSelector<Terms...>::record_gradient_check(const GradientCheck& check) {
+    verified_samples_.fetch_add(1, std::memory_order_relaxed);
+    Scalar current = verified_max_error_.load(std::memory_order_relaxed);
+    while (check.max_abs_error > current &&
+           !verified_max_error_.compare_exchange_weak(current, check.max_abs_error, std::memory_order_relaxed)) {
+    }
+}
+
+template <typename... Terms>
+inline auto BasicActionSelector<Terms...>::apply_constraints(
     const Vec2& velocity,
     Scalar fatigue
 ) -> Vec2 {
@@ -156,7 +719,7 @@ inline auto ActionSelector::apply_constraints(
     using namespace eph::math;
 
     // 高疲労 → 強制休息
-    if (fatigue > 0.8) {
+    if (resting(fatigue)) {
         return Vec2::Zero();
     }
 
@@ -174,16 +737,26 @@ inline auto ActionSelector::apply_constraints(
     return velocity * (v_clamped / v_mag);
 }
 
-inline auto ActionSelector::select_action(
+template <typename... Terms>
+template <typename SpmT>
+inline auto BasicActionSelector<Terms...>::select_action(
     const Vec2& current_velocity,
     const Matrix12x12& haze,
-    const spm::SaliencyPolarMap& spm,
-    Scalar fatigue
+    const SpmT& spm,
+    Scalar fatigue,
+    int spm_level
 ) -> Vec2 {
     using namespace eph::constants;
 
-    // 1. EFE勾配計算
-    Vec2 grad = compute_efe_gradient(current_velocity, haze, spm, fatigue);
+    // 1. EFE勾配計算（解析解。検証スイッチ有効時は中心差分で更新し、差を集計）
+    Vec2 grad;
+    if (gradient_verification()) {
+        const GradientCheck check = check_efe_gradient(current_velocity, haze, spm, fatigue, spm_level);
+        record_gradient_check(check);
+        grad = check.finite_difference;
+    } else {
+        grad = compute_efe_gradient(current_velocity, haze, spm, fatigue, spm_level);
+    }
 
     // 2. 勾配降下: v_new = v_old - η∇G
     Vec2 new_velocity = current_velocity - LEARNING_RATE * grad;
@@ -194,6 +767,269 @@ inline auto ActionSelector::select_action(
     return new_velocity;
 }
 
+template <typename... Terms>
+template <typename SpmT>
+inline auto BasicActionSelector<Terms...>::select_action_with_efe(
+    const Vec2& current_velocity,
+    const Matrix12x12& haze,
+    const SpmT& spm,
+    Scalar fatigue,
+    int spm_level
+) -> ActionSelection {
+    ActionSelection selection;
+    selection.velocity = select_action(current_velocity, haze, spm, fatigue, spm_level);
+    selection.efe = compute_efe_terms(selection.velocity, haze, spm, fatigue, spm_level);
+    return selection;
+}
+
+template <typename... Terms>
+inline void BasicActionSelector<Terms...>::select_action_batch(ActionBatch& batch) {
+    using namespace eph::constants;
+    using Block = Eigen::Array<Scalar, Eigen::Dynamic, 1, Eigen::ColMajor, kBatchBlock, 1>;
+
+    const Eigen::Index n = batch.size();
+    assert(batch.vy.size() == n && batch.fatigue.size() == n && batch.pragmatic.size() == n);
+    assert(batch.context.rows() == n && batch.context.cols() == kContextSize);
+
+    for (Eigen::Index start = 0; start < n; start += kBatchBlock) {
+        const Eigen::Index len = std::min<Eigen::Index>(kBatchBlock, n - start);
+        auto vx = batch.vx.segment(start, len);
+        auto vy = batch.vy.segment(start, len);
+        const auto fatigue = batch.fatigue.segment(start, len);
+        const auto context = batch.context.middleRows(start, len);
+
+        // 1. Pragmatic項の解析勾配（|v| < EPS では勾配 0）
+        const Block v_mag = (vx.square() + vy.square()).sqrt();
+        const Block gx = sum_terms<true>([&](auto term, auto offset) {
+            const auto ctx = [&](int k) { return context.col(offset + k); };
+            return decltype(term)::gradient_x(ctx, fatigue, vx, vy, v_mag);
+        });
+        const Block gy = sum_terms<true>([&](auto term, auto offset) {
+            const auto ctx = [&](int k) { return context.col(offset + k); };
+            return decltype(term)::gradient_y(ctx, fatigue, vx, vy, v_mag);
+        });
+        const auto moving = v_mag >= EPS;
+
+        // 2. 勾配降下
+        const Block nx = vx - LEARNING_RATE * moving.select(gx, Scalar(0.0));
+        const Block ny = vy - LEARNING_RATE * moving.select(gy, Scalar(0.0));
+
+        // 3. 制約（強制休息 → 0、ゼロ速度 → (V_MIN, 0)、|v| を [V_MIN, V_MAX] に）
+        const Block n_mag = (nx.square() + ny.square()).sqrt();
+        const Block ratio = n_mag.min(V_MAX).max(V_MIN) / n_mag;
+        const auto rest = resting(fatigue);
+        const auto stopped = n_mag < EPS;
+
+        vx = rest.select(Scalar(0.0), stopped.select(V_MIN, nx * ratio));
+        vy = rest.select(Scalar(0.0), stopped.select(Scalar(0.0), ny * ratio));
+
+        // 4. 更新後の速度での Pragmatic項
+        const Block v_new_mag = (vx.square() + vy.square()).sqrt();
+        batch.pragmatic.segment(start, len) = sum_terms<true>([&](auto term, auto offset) {
+            const auto ctx = [&](int k) { return context.col(offset + k); };
+            return decltype(term)::value(ctx, fatigue, vx, vy, v_new_mag);
+        });
+    }
+}
+
+template <typename... Terms>
+template <typename SpmT>
+inline auto BasicActionSelector<Terms...>::select_action_line_search(
+    const Vec2& current_velocity,
+    const Matrix12x12& haze,
+    const SpmT& spm,
+    Scalar fatigue,
+    const DescentOptions& options,
+    int spm_level
+) -> ActionSelection {
+    ActionSelection selection;
+    selection.stats.iterations = 0;
+
+    // 文脈量は v に依存しないので反復の前に1回だけ
+    const Context context = compute_context(haze, spm, spm_level);
+
+    // 実行可能な初期点（高疲労なら強制休息で終了）
+    Vec2 v = apply_constraints(current_velocity, fatigue);
+    Scalar g_value = pragmatic_value(context, v, fatigue);
+
+    if (!resting(fatigue)) {
+        const Scalar tol = options.gradient_tolerance;
+        for (int it = 0; it < options.max_iterations; ++it) {
+            const Vec2 grad = pragmatic_gradient(context, v, fatigue);
+            if (grad.norm() <= tol) {
+                break;
+            }
+
+            // Armijo バックトラック
+            Scalar eta = options.initial_step;
+            bool converged = false;
+            bool accepted = false;
+            Vec2 trial;
+            Scalar trial_value = 0.0;
+            for (int bt = 0; bt <= options.max_backtracks; ++bt) {
+                trial = apply_constraints(v - eta * grad, fatigue);
+                const Vec2 step = trial - v;
+                if (step.norm() <= tol * eta) {
+                    converged = true;  // 射影勾配がゼロ（制約境界上の停留点）
+                    break;
+                }
+                trial_value = pragmatic_value(context, trial, fatigue);
+                ++selection.stats.evaluations;
+                if (trial_value <= g_value + options.armijo * grad.dot(step)) {
+                    accepted = true;
+                    break;
+                }
+                eta *= options.backtrack;
+            }
+            if (converged || !accepted) {
+                break;
+            }
+
+            v = trial;
+            g_value = trial_value;
+            ++selection.stats.iterations;
+        }
+    }
+
+    selection.velocity = v;
+    selection.efe.epistemic = compute_epistemic(haze, spm, spm_level);
+    selection.efe.pragmatic = g_value;
+    return selection;
+}
+
+template <typename... Terms>
+inline auto BasicActionSelector<Terms...>::best_candidate(
+    const Vec2& current_velocity,
+    Scalar epistemic,
+    const Context& context,
+    Scalar fatigue,
+    const CandidateLattice& lattice,
+    Scalar& pragmatic
+) -> Vec2 {
+    using namespace eph::constants;
+    using Array = CandidateLattice::Array;
+
+    // 高疲労 → 強制休息
+    if (resting(fatigue)) {
+        pragmatic = pragmatic_value(context, Vec2::Zero(), fatigue);
+        return Vec2::Zero();
+    }
+
+    // 進行方向（静止時は +x）
+    Scalar hx = 1.0;
+    Scalar hy = 0.0;
+    const Scalar v_mag = current_velocity.norm();
+    if (v_mag >= EPS) {
+        hx = current_velocity.x() / v_mag;
+        hy = current_velocity.y() / v_mag;
+    }
+
+    // 全候補の G = Epistemic + Pragmatic を一括評価
+    // （Pragmatic項は候補の配列式、|c| = speed: 回転は長さを保つ）
+    const auto& speed = lattice.speed();
+    const auto cx = speed * (lattice.cos_angle() * hx - lattice.sin_angle() * hy);
+    const auto cy = speed * (lattice.sin_angle() * hx + lattice.cos_angle() * hy);
+    const Array candidate_pragmatic = sum_terms<true>([&](auto term, auto offset) {
+        const auto ctx = [&](int k) { return context(offset + k); };
+        return decltype(term)::value(ctx, fatigue, cx, cy, speed);
+    });
+
+    Eigen::Index best = 0;
+    (epistemic + candidate_pragmatic).minCoeff(&best);
+    pragmatic = candidate_pragmatic(best);
+    return lattice.candidate(best, hx, hy);
+}
+
+template <typename... Terms>
+template <typename SpmT>
+inline auto BasicActionSelector<Terms...>::select_action_sampled(
+    const Vec2& current_velocity,
+    const Matrix12x12& haze,
+    const SpmT& spm,
+    Scalar fatigue,
+    const CandidateLattice& lattice,
+    int spm_level
+) -> ActionSelection {
+    ActionSelection selection;
+    selection.efe.epistemic = compute_epistemic(haze, spm, spm_level);
+    selection.velocity = best_candidate(current_velocity, selection.efe.epistemic,
+                                        compute_context(haze, spm, spm_level), fatigue, lattice,
+                                        selection.efe.pragmatic);
+    return selection;
+}
+
+template <typename... Terms>
+inline void BasicActionSelector<Terms...>::select_action_sampled_batch(ActionBatch& batch, const CandidateLattice& lattice) {
+    using namespace eph::constants;
+    using Grid = Eigen::Array<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+    using Block = Eigen::Array<Scalar, Eigen::Dynamic, 1, Eigen::ColMajor, kSampleBlock, 1>;
+
+    const Eigen::Index n = batch.size();
+    assert(batch.vy.size() == n && batch.fatigue.size() == n && batch.pragmatic.size() == n);
+    assert(batch.epistemic.size() == n);
+    assert(batch.context.rows() == n && batch.context.cols() == kContextSize);
+
+    // 候補 × エージェント（列）の作業領域（呼び出しごとに1回だけ確保）
+    const Eigen::Index m = lattice.size();
+    Grid cx(m, kSampleBlock);
+    Grid cy(m, kSampleBlock);
+    Grid candidate_pragmatic(m, kSampleBlock);
+
+    for (Eigen::Index start = 0; start < n; start += kSampleBlock) {
+        const Eigen::Index len = std::min<Eigen::Index>(kSampleBlock, n - start);
+        auto vx = batch.vx.segment(start, len);
+        auto vy = batch.vy.segment(start, len);
+        const auto fatigue = batch.fatigue.segment(start, len);
+        const auto context = batch.context.middleRows(start, len);
+
+        // 1. 進行方向（静止時は +x）
+        const Block v_mag = (vx.square() + vy.square()).sqrt();
+        const auto moving = v_mag >= EPS;
+        const Block hx = moving.select(vx / v_mag, Scalar(1.0));
+        const Block hy = moving.select(vy / v_mag, Scalar(0.0));
+
+        // 2. 全候補を回転（行: 候補、列: エージェント。エージェントの量は行方向に複製）
+        const auto speed = lattice.speed().replicate(1, len);
+        const auto cos_angle = lattice.cos_angle().replicate(1, len);
+        const auto sin_angle = lattice.sin_angle().replicate(1, len);
+        const auto hx_grid = hx.transpose().replicate(m, 1);
+        const auto hy_grid = hy.transpose().replicate(m, 1);
+        auto cxb = cx.leftCols(len);
+        auto cyb = cy.leftCols(len);
+        cxb = speed * (cos_angle * hx_grid - sin_angle * hy_grid);
+        cyb = speed * (sin_angle * hx_grid + cos_angle * hy_grid);
+
+        // 3. 全候補の Pragmatic項
+        const auto fatigue_grid = fatigue.transpose().replicate(m, 1);
+        auto pragmatic = candidate_pragmatic.leftCols(len);
+        pragmatic = sum_terms<true>([&](auto term, auto offset) {
+            const auto ctx = [&](int k) { return context.col(offset + k).transpose().replicate(m, 1); };
+            return decltype(term)::value(ctx, fatigue_grid, cxb, cyb, speed);
+        });
+
+        // 4. エージェントごとに G = Epistemic + Pragmatic が最小の候補（高疲労 → 強制休息）
+        for (Eigen::Index j = 0; j < len; ++j) {
+            const Eigen::Index i = start + j;
+            if (resting(fatigue(j))) {
+                const Context rest_context = context.row(j).transpose();
+                batch.pragmatic(i) = pragmatic_value(rest_context, Vec2::Zero(), fatigue(j));
+                vx(j) = 0.0;
+                vy(j) = 0.0;
+                continue;
+            }
+            Eigen::Index best = 0;
+            (batch.epistemic(i) + pragmatic.col(j)).minCoeff(&best);
+            const Vec2 v = lattice.candidate(best, hx(j), hy(j));
+            batch.pragmatic(i) = pragmatic(best, j);
+            vx(j) = v.x();
+            vy(j) = v.y();
+        }
+    }
+}
+
+// 標準構成: G(v) = ⟨h⟩·⟨|∇SPM|⟩ + κ(fatigue)·|v|
+using ActionSelector = BasicActionSelector<efe::HazeSaliency, efe::FatigueCost>;
+
 }  // namespace eph::agent
 
 #endif  // EPH_AGENT_ACTION_SELECTOR_HPP
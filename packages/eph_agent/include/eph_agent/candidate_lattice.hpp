@@ -0,0 +1,117 @@
+#ifndef EPH_AGENT_CANDIDATE_LATTICE_HPP
+#define EPH_AGENT_CANDIDATE_LATTICE_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include "eph_core/types.hpp"
+#include "eph_core/constants.hpp"
+
+namespace eph::agent {
+
+/**
+ * @brief 候補サンプリング型の行為選択で評価する速度候補（極座標格子 + 摂動）
+ *
+ * 速度空間の極座標格子 speeds × directions（M = speeds · directions 個）。
+ * 方向は現在の進行方向からの相対角で、エージェントごとに回転させて使う。
+ *
+ * - 速さ: [V_MIN, V_MAX] を speeds 段に等分（speeds == 1 なら V_MIN のみ）
+ * - 方向: 2π を directions 等分
+ * - 摂動: 格子間隔 × jitter の一様乱数（seed 固定、構築時に1回だけ引く）。
+ *   格子の偏りによる取りこぼしを減らす。直進方向（d = 0）と最低速の段は摂動しない
+ *
+ * 候補の並びは速さの段ごと（index = s · directions + d）。EFE が等しい候補は
+ * 先頭（低速・直進側）が選ばれる。
+ */
+class CandidateLattice {
+public:
+    using Scalar = eph::Scalar;
+    using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+
+    /**
+     * @brief コンストラクタ
+     * @param directions 方向数（≥ 1）
+     * @param speeds 速さの段数（≥ 1）
+     * @param jitter 摂動の大きさ（格子間隔に対する比、[0, 1)）
+     * @param seed 摂動の乱数シード
+     */
+    explicit CandidateLattice(int directions = 16, int speeds = 4, Scalar jitter = 0.25,
+                              std::uint32_t seed = 0)
+        : directions_(directions)
+        , speeds_(speeds)
+    {
+        using namespace eph::constants;
+        assert(directions >= 1 && speeds >= 1);
+
+        const int m = directions * speeds;
+        speed_.resize(m);
+        cos_angle_.resize(m);
+        sin_angle_.resize(m);
+
+        // 乱数は常に倍精度で生成（単精度構成でも同一の格子を再現するため）
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> unit(-0.5, 0.5);
+
+        const double d_angle = 2.0 * PI / directions;
+        const double d_speed = speeds > 1 ? (V_MAX - V_MIN) / (speeds - 1) : 0.0;
+
+        for (int s = 0; s < speeds; ++s) {
+            for (int d = 0; d < directions; ++d) {
+                double speed = V_MIN + d_speed * s;
+                double angle = d_angle * d;
+                if (s > 0) {
+                    speed = std::clamp(speed + jitter * d_speed * unit(rng),
+                                       static_cast<double>(V_MIN), static_cast<double>(V_MAX));
+                }
+                if (d > 0) {
+                    angle += jitter * d_angle * unit(rng);
+                }
+
+                const int i = s * directions + d;
+                speed_(i) = static_cast<Scalar>(speed);
+                cos_angle_(i) = static_cast<Scalar>(std::cos(angle));
+                sin_angle_(i) = static_cast<Scalar>(std::sin(angle));
+            }
+        }
+    }
+
+    // 候補数 M（評価予算）
+    auto size() const -> Eigen::Index { return speed_.size(); }
+    auto directions() const -> int { return directions_; }
+    auto speeds() const -> int { return speeds_; }
+
+    // 候補 i の速さ [m/s] と進行方向からの相対角（cos, sin）
+    auto speed() const -> const Array& { return speed_; }
+    auto cos_angle() const -> const Array& { return cos_angle_; }
+    auto sin_angle() const -> const Array& { return sin_angle_; }
+
+    /**
+     * @brief 候補 i の速度（進行方向 heading = (hx, hy), |heading| = 1 で回転）
+     */
+    auto candidate(Eigen::Index i, Scalar hx, Scalar hy) const -> Vec2 {
+        return speed_(i) * Vec2(cos_angle_(i) * hx - sin_angle_(i) * hy,
+                                sin_angle_(i) * hx + cos_angle_(i) * hy);
+    }
+
+    // 標準格子（16方向 × 4段、M = 64）
+    static auto standard() -> const std::shared_ptr<const CandidateLattice>& {
+        static const std::shared_ptr<const CandidateLattice> lattice =
+            std::make_shared<const CandidateLattice>();
+        return lattice;
+    }
+
+private:
+    int directions_;
+    int speeds_;
+    Array speed_;
+    Array cos_angle_;
+    Array sin_angle_;
+};
+
+}  // namespace eph::agent
+
+#endif  // EPH_AGENT_CANDIDATE_LATTICE_HPP
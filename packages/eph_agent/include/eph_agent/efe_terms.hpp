@@ -0,0 +1,113 @@
+#ifndef EPH_AGENT_EFE_TERMS_HPP
+#define EPH_AGENT_EFE_TERMS_HPP
+
+#include <Eigen/Core>
+#include "eph_core/types.hpp"
+#include "eph_spm/channel_set.hpp"
+#include "eph_spm/polar_grid.hpp"
+
+namespace eph::agent::efe {
+
+/**
+ * @brief Expected Free Energy の項（BasicActionSelector<Terms...> のポリシー）
+ *
+ * G(v) = Σ Epistemic項 + Σ Pragmatic項 として、項ごとに値と解析勾配を与える。
+ * BasicActionSelector は項の並びをコンパイル時に展開して1つのカーネルに融合する
+ * （仮想関数なし）。項は状態を持たない型で、静的メンバのみを持つ。
+ *
+ * ## Epistemic項（kVelocityDependent = false）
+ * v に依存しない（勾配 0）。エージェントごとに1回だけ評価する。
+ * ```cpp
+ * static constexpr bool kVelocityDependent = false;
+ * static constexpr spm::ChannelMask kReadChannels = ...;
+ * template <typename SpmT>
+ * static auto value(const Matrix12x12& haze, const SpmT& spm, int spm_level) -> Scalar;
+ * ```
+ *
+ * ## Pragmatic項（kVelocityDependent = true）
+ * 速度 v に依存する項。疲労度に加え、エージェントごとの文脈量 ctx（SPM・Haze から
+ * 速度によらず1回だけ求める kContextSize 個の値、context()）を読める。SPM と v を
+ * 結合する項（例: 前方の衝突リスクに応じて速さを抑える）は ctx を通して書く。
+ * 引数はスカラー（1エージェント）または Eigen 配列式（SoAバッチ・候補サンプリング）で、
+ * 同じ式で両方を扱う。ctx(k) も同様にスカラーまたは配列式を返す（k < kContextSize）。
+ * speed = |v| は呼び出し側が計算済みの値を渡す。勾配は |v| ≥ EPS でのみ呼ばれ、
+ * 原点では全項とも劣勾配 0 とする。戻り値の式は引数のみを参照すること。
+ * kContextSize = 0 の項は context() を持たなくてよい。
+ * ```cpp
+ * static constexpr bool kVelocityDependent = true;
+ * static constexpr spm::ChannelMask kReadChannels = ...;  // context() が読むチャネル
+ * static constexpr int kContextSize = K;
+ * template <typename SpmT>
+ * static auto context(const Matrix12x12& haze, const SpmT& spm, int spm_level)
+ *     -> Eigen::Array<Scalar, K, 1>;
+ * template <typename C, typename F, typename VX, typename VY, typename S>
+ * static auto value(const C& ctx, const F& fatigue, const VX& vx, const VY& vy, const S& speed);
+ * template <typename C, typename F, typename VX, typename VY, typename S>
+ * static auto gradient_x(const C& ctx, const F& fatigue, const VX& vx, const VY& vy, const S& speed);
+ * template <typename C, typename F, typename VX, typename VY, typename S>
+ * static auto gradient_y(const C& ctx, const F& fatigue, const VX& vx, const VY& vy, const S& speed);
+ * ```
+ */
+
+// 項の文脈量の数（Epistemic項は 0）
+template <typename T>
+constexpr auto context_size() -> int {
+    if constexpr (T::kVelocityDependent) {
+        return T::kContextSize;
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * @brief Epistemic項: ⟨h⟩ · ⟨|∇SPM|⟩（Haze × 環境勾配、不確実性駆動探索）
+ *
+ * いずれも視野内平均。⟨|∇SPM|⟩ はSPM側で書き込み時に確定した値を読む。
+ */
+struct HazeSaliency {
+    static constexpr bool kVelocityDependent = false;
+    static constexpr spm::ChannelMask kReadChannels = spm::kChannelMask<ChannelID::F2>;
+
+    template <typename SpmT>
+    static auto value(const Matrix12x12& haze, const SpmT& spm, int spm_level) -> Scalar {
+        Scalar avg_haze = spm::visible_mean(haze);
+        Scalar avg_grad = spm.gradient_magnitude_mean(eph::ChannelID::F2, spm_level);  // F2 = Saliency
+        return avg_haze * avg_grad;
+    }
+};
+
+/**
+ * @brief Pragmatic項: κ(fatigue) · |v|（疲労 × 速度、エネルギーコスト）
+ *
+ * ∇_v = κ(fatigue) · v/|v|
+ */
+struct FatigueCost {
+    static constexpr bool kVelocityDependent = true;
+    static constexpr spm::ChannelMask kReadChannels = spm::kNoChannels;
+    static constexpr int kContextSize = 0;  // SPM・Hazeを読まない
+
+    // 重み κ(fatigue)（疲労が高い → コスト増）
+    template <typename F>
+    static auto weight(const F& fatigue) {
+        return Scalar(1.0) + Scalar(5.0) * fatigue;
+    }
+
+    template <typename C, typename F, typename VX, typename VY, typename S>
+    static auto value(const C& /*ctx*/, const F& fatigue, const VX& /*vx*/, const VY& /*vy*/, const S& speed) {
+        return weight(fatigue) * speed;
+    }
+
+    template <typename C, typename F, typename VX, typename VY, typename S>
+    static auto gradient_x(const C& /*ctx*/, const F& fatigue, const VX& vx, const VY& /*vy*/, const S& speed) {
+        return (weight(fatigue) / speed) * vx;
+    }
+
+    template <typename C, typename F, typename VX, typename VY, typename S>
+    static auto gradient_y(const C& /*ctx*/, const F& fatigue, const VX& /*vx*/, const VY& vy, const S& speed) {
+        return (weight(fatigue) / speed) * vy;
+    }
+};
+
+}  // namespace eph::agent::efe
+
+#endif  // EPH_AGENT_EFE_TERMS_HPP
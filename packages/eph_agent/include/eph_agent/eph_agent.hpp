@@ -2,6 +2,9 @@
 #define EPH_AGENT_EPH_AGENT_HPP
 
 #include <Eigen/Core>
+#include <algorithm>
+#include <memory>
+#include <utility>
 #include "eph_core/types.hpp"
 #include "eph_core/constants.hpp"
 #include "eph_core/math_utils.hpp"
@@ -16,6 +19,10 @@ namespace eph::agent {
  *
  * 単一エージェントの状態管理、Haze推定、行為決定を行います。
  * Expected Free Energy (EFE) 勾配降下による行為選択を実装。
+ *
+ * update() が読むSPMチャネルは kReadChannels（行為選択 + Haze推定）。
+ * 知覚側はこの集合だけを生成すればよい（SpmRasterizer::rasterize<kReadChannels>、
+ * spm::LazySpm）。
  */
 class EPHAgent {
 public:
@@ -23,6 +30,10 @@ public:
     using Vec2 = eph::Vec2;
     using Matrix12x12 = eph::Matrix12x12;
 
+    // update() が読むSPMチャネル
+    static constexpr spm::ChannelMask kReadChannels =
+        ActionSelector::kReadChannels | HazeEstimator::kReadChannels;
+
     /**
      * @brief コンストラクタ
      * @param initial_state 初期状態（位置・速度・κ・疲労度）
@@ -51,21 +62,72 @@ public:
      *       ↑                                                      ↓
      *       └──────────────────── Feedback ──────────────────────┘
      *
-     * @param spm Saliency Polar Map
+     * @param spm Saliency Polar Map（SaliencyPolarMap または SpmBatch のビュー）
+     * @param dt タイムステップ [s]
+     */
+    template <typename SpmT>
+    void update(const SpmT& spm, Scalar dt) {
+        // 1. 行為選択（EFE勾配降下・候補サンプリング・直線探索）
+        ActionSelection selection;
+        switch (selection_mode_) {
+            case SelectionMode::Sampling:
+                selection = ActionSelector::select_action_sampled(
+                    state_.velocity, haze_, spm, state_.fatigue, *lattice_, spm_level_);
+                break;
+            case SelectionMode::LineSearch:
+                selection = ActionSelector::select_action_line_search(
+                    state_.velocity, haze_, spm, state_.fatigue, descent_options_, spm_level_);
+                break;
+            case SelectionMode::Gradient:
+            default:
+                selection = ActionSelector::select_action_with_efe(
+                    state_.velocity, haze_, spm, state_.fatigue, spm_level_);
+                break;
+        }
+
+        apply_action(spm, selection, dt);
+    }
+
+    /**
+     * @brief 選択済みの行為を適用（update() の手順 2〜5）
+     *
+     * 群全体の行為選択を ActionSelector::select_action_batch() でまとめて行う場合に使用。
+     * update(spm, dt) は選択方式に応じた ActionSelector の結果
+     * （select_action_with_efe() / select_action_sampled() / select_action_line_search()）
+     * でこれを呼ぶのと同一。
+     *
+     * @param spm Saliency Polar Map（Haze推定に使用）
+     * @param selection 行為選択の結果（新しい速度 [m/s] と EFE の内訳）
+     * @param dt タイムステップ [s]
+     */
+    template <typename SpmT>
+    void apply_action(const SpmT& spm, const ActionSelection& selection, Scalar dt) {
+        // 2, 3, 5. 状態更新・予測誤差・疲労度
+        Scalar prediction_error = apply_motion(selection, dt);
+
+        // 4. Haze推定（haze_ へ直接書き込む）
+        haze_estimator_.estimate_into(spm, prediction_error, haze_);
+    }
+
+    /**
+     * @brief 選択済みの行為による状態更新（apply_action() の Haze推定以外）
+     *
+     * 状態更新・予測誤差・疲労度更新を行い、予測誤差を返す。Haze推定を群全体で
+     * まとめて行う場合（swarm::HazeBatch）に使用。apply_action() はこれに続けて
+     * 返した予測誤差で Haze を推定するのと同一（疲労度は Haze推定に影響しない）。
+     *
+     * @param selection 行為選択の結果
      * @param dt タイムステップ [s]
+     * @return 予測誤差 [0, 1]
      */
-    void update(const spm::SaliencyPolarMap& spm, Scalar dt) {
+    auto apply_motion(const ActionSelection& selection, Scalar dt) -> Scalar {
         using namespace eph::constants;
         using namespace eph::math;
 
-        // 1. 行為選択（EFE勾配降下）
+        const Vec2& new_velocity = selection.velocity;
         Vec2 old_velocity = state_.velocity;
-        Vec2 new_velocity = ActionSelector::select_action(
-            old_velocity,
-            haze_,
-            spm,
-            state_.fatigue
-        );
+        efe_ = selection.efe;
+        solver_stats_ = selection.stats;
 
         // 2. 状態更新
         state_.velocity = new_velocity;
@@ -82,12 +144,9 @@ public:
         Scalar velocity_change = (new_velocity - old_velocity).norm();
         Scalar prediction_error = clamp(velocity_change / V_MAX, 0.0, 1.0);
 
-        // 4. Haze推定
-        haze_ = haze_estimator_.estimate(spm, prediction_error);
-
-        // 5. 疲労度更新
+        // 5. 疲労度更新（V_MIN にクリップされた速さは丸め誤差によらず休息側）
         Scalar speed = state_.velocity.norm();
-        if (speed > V_MIN) {
+        if (speed > V_MIN + THRESHOLD_MARGIN) {
             // 移動中: 疲労蓄積
             state_.fatigue += FATIGUE_RATE * dt;
         } else {
@@ -97,6 +156,8 @@ public:
 
         // 疲労度を[0, 1]にクリップ
         state_.fatigue = clamp(state_.fatigue, 0.0, 1.0);
+
+        return prediction_error;
     }
 
     /**
@@ -108,8 +169,9 @@ public:
      * @param prediction_error 予測誤差 [0, 1]
      * @return 推定されたHazeフィールド [0, 1]
      */
-    auto estimate_haze(const spm::SaliencyPolarMap& spm, Scalar prediction_error) -> Matrix12x12 {
-        haze_ = haze_estimator_.estimate(spm, prediction_error);
+    template <typename SpmT>
+    auto estimate_haze(const SpmT& spm, Scalar prediction_error) -> Matrix12x12 {
+        haze_estimator_.estimate_into(spm, prediction_error, haze_);
         return haze_;
     }
 
@@ -121,6 +183,34 @@ public:
         return state_;
     }
 
+    /**
+     * @brief エージェント状態の設定
+     *
+     * シナリオ初期配置や記録の再生で使用します。Haze推定器の状態は変更しません。
+     *
+     * @param state 新しい状態
+     */
+    void set_state(const AgentState& state) {
+        state_ = state;
+    }
+
+    /**
+     * @brief 直近の行為選択で評価した EFE の内訳
+     *
+     * 選んだ速度（update() 後の速度）と update() 前のHaze・疲労度での G(v)。
+     * 最初の update() 前は 0。
+     */
+    auto efe() const -> const EfeTerms& {
+        return efe_;
+    }
+
+    /**
+     * @brief 直近の行為選択の計算量（反復数・G の評価回数）
+     */
+    auto solver_stats() const -> const SolverStats& {
+        return solver_stats_;
+    }
+
     /**
      * @brief Haze感度取得
      * @return κ値 [0.3-1.5]
@@ -149,6 +239,67 @@ public:
         haze_ = h_eff;
     }
 
+    /**
+     * @brief 行為選択で使うSPMピラミッド段の設定
+     *
+     * 0 は元の解像度（12×12）、1 / 2 は 6×6 / 3×3 に粗視化した段で
+     * ⟨|∇SPM|⟩ を評価する。遠方・低重要度のエージェントの計算量削減用。
+     *
+     * @param level ピラミッド段 [0, spm::SaliencyPolarMap::kPyramidLevels)（範囲外は丸める）
+     */
+    void set_spm_level(int level) {
+        spm_level_ = std::clamp(level, 0, spm::SaliencyPolarMap::kPyramidLevels - 1);
+    }
+
+    auto spm_level() const -> int {
+        return spm_level_;
+    }
+
+    /**
+     * @brief 行為選択の方式を設定
+     *
+     * SelectionMode::Sampling では lattice の候補から最小 EFE の速度を選ぶ
+     * （lattice 省略時は CandidateLattice::standard()）。SelectionMode::LineSearch の
+     * 設定は set_descent_options()。実行中に切り替えてよい。
+     *
+     * @param mode 行為選択の方式
+     * @param lattice 速度候補（候補サンプリング用）
+     */
+    void set_selection_mode(SelectionMode mode, std::shared_ptr<const CandidateLattice> lattice = nullptr) {
+        selection_mode_ = mode;
+        lattice_ = lattice ? std::move(lattice) : CandidateLattice::standard();
+    }
+
+    auto selection_mode() const -> SelectionMode {
+        return selection_mode_;
+    }
+
+    auto candidate_lattice() const -> const CandidateLattice& {
+        return *lattice_;
+    }
+
+    /**
+     * @brief 反復勾配降下（SelectionMode::LineSearch）の設定
+     */
+    void set_descent_options(const DescentOptions& options) {
+        descent_options_ = options;
+    }
+
+    auto descent_options() const -> const DescentOptions& {
+        return descent_options_;
+    }
+
+    /**
+     * @brief Haze推定器（EMA状態の参照・群のバッチ処理との受け渡し用）
+     */
+    auto haze_estimator() const -> const HazeEstimator& {
+        return haze_estimator_;
+    }
+
+    auto haze_estimator() -> HazeEstimator& {
+        return haze_estimator_;
+    }
+
     /**
      * @brief Haze推定器をリセット
      *
@@ -164,6 +315,12 @@ private:
     AgentState state_;              // エージェント状態
     Matrix12x12 haze_;              // 現在のHazeフィールド
     HazeEstimator haze_estimator_;  // Haze推定器
+    int spm_level_ = 0;             // 行為選択のSPMピラミッド段
+    EfeTerms efe_;                  // 直近の行為選択での EFE
+    SelectionMode selection_mode_ = SelectionMode::Gradient;                      // 行為選択の方式
+    std::shared_ptr<const CandidateLattice> lattice_ = CandidateLattice::standard();  // 速度候補
+    DescentOptions descent_options_;                // 反復勾配降下の設定
+    SolverStats solver_stats_;                      // 直近の行為選択の計算量
 };
 
 }  // namespace eph::agent
@@ -2,10 +2,18 @@
 #define EPH_AGENT_HAZE_ESTIMATOR_HPP
 
 #include <Eigen/Core>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <type_traits>
 #include "eph_core/types.hpp"
 #include "eph_core/constants.hpp"
 #include "eph_core/math_utils.hpp"
+#include "eph_spm/channel_set.hpp"
 #include "eph_spm/saliency_polar_map.hpp"
+#include "eph_spm/polar_grid.hpp"
+#include "eph_spm/separable_blur.hpp"
 
 namespace eph::agent {
 
@@ -14,19 +22,62 @@ namespace eph::agent {
  *
  * 予測誤差・不確実性・可視性・観測安定性からHazeフィールドを推定します。
  * EMAフィルタと空間平滑化を使用して数値的に安定な推定を行います。
+ *
+ * 視野外（死角）ビンのHazeは推定せず0とします。平滑化は死角の行のうち
+ * 周期近傍（視野からカーネル半径以内）の平滑化前の値だけを読むため、
+ * 視野内の値はマスクなしの計算と一致します。
+ *
+ * 空間平滑化は二項係数カーネルによる分離可能ガウシアン（spm::blur::separable()）。
+ * σ はコンストラクタで指定し、対応する σ（kBlurSigmas）のうち最も近いものを使う。
+ *
+ * R1・F4・F5 がいずれも一様チャネル（SPM の uniform_value()）の場合は入力が
+ * 空間一様になるため、Sigmoid を1回だけ評価し、平滑化も定数の解析解で済ませます
+ * （結果は一般経路と一致。Sigmoid は高速経路がスカラー版、一般経路が配列版のため、
+ * Exact では配列の SIMD exp との差の数 ULP 以内、Fast ではビット単位）。
+ *
+ * 予測誤差のEMAは通常スカラー（EPHAgent の予測誤差は1エージェント1値なので
+ * 全ビンが常に等しい）。ビンごとの予測誤差が与えられたとき（estimate() の
+ * フィールド版）に初めて 12×12 のEMAフィールドを確保し、以後はフィールドで保持する。
+ *
+ * Sigmoid は12×12の配列単位で評価し（math::sigmoid<Mode>()）、精度モードは
+ * テンプレート引数でコンパイル時に選ぶ。Exact は SIMD の exp（従来のスカラー sigmoid() と
+ * 相対 4 ULP 未満の差）、Fast は超越関数を使わない有理近似（最大絶対誤差
+ * math::SIGMOID_FAST_MAX_ERROR）。
+ *
+ * 読むSPMチャネルは kReadChannels（R1, F4, F5）のみ。
+ *
+ * @tparam Mode Sigmoid の精度モード
  */
-class HazeEstimator {
+template <math::SigmoidMode Mode>
+class BasicHazeEstimator {
 public:
     using Scalar = eph::Scalar;
     using Matrix12x12 = eph::Matrix12x12;
+    using EmaField = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+
+    // estimate() が読むSPMチャネル
+    static constexpr spm::ChannelMask kReadChannels =
+        spm::kChannelMask<ChannelID::R1, ChannelID::F4, ChannelID::F5>;
+
+    // Sigmoid の精度モード
+    static constexpr math::SigmoidMode kSigmoidMode = Mode;
+
+    // 平滑化の二項カーネル次数と σ = √次数 / 2 [ビン]（半径 1, 2, 4, 8）
+    static constexpr int kBlurOrders[] = {2, 4, 8, 16};
+    static constexpr Scalar kBlurSigmas[] = {0.70710678118654752, 1.0, 1.41421356237309505, 2.0};
+
+    // 既定の σ（3×3カーネル [1 2 1]⊗[1 2 1] / 16）
+    static constexpr Scalar kDefaultBlurSigma = kBlurSigmas[0];
 
     /**
      * @brief コンストラクタ
      * @param tau EMA時定数（デフォルト: 1.0）
+     * @param blur_sigma 平滑化の標準偏差 [ビン]（kBlurSigmas の最も近い値に丸める）
      */
-    explicit HazeEstimator(Scalar tau = 1.0)
+    explicit BasicHazeEstimator(Scalar tau = 1.0, Scalar blur_sigma = kDefaultBlurSigma)
         : tau_(tau)
-        , ema_error_(Matrix12x12::Zero())
+        , ema_error_(0.0)
+        , blur_order_(nearest_blur_order(blur_sigma))
         , initialized_(false)
     {}
 
@@ -35,108 +86,364 @@ public:
      *
      * h̃ = σ(a·EMA(e) + b·R1 + c·(1-F4) + d·F5)
      *
-     * @param spm Saliency Polar Map
+     * @param spm Saliency Polar Map（SaliencyPolarMap または SpmBatch のビュー）
      * @param prediction_error 予測誤差 [0, 1]
      * @return Hazeフィールド [0, 1]
      */
+    template <typename SpmT>
     auto estimate(
-        const spm::SaliencyPolarMap& spm,
+        const SpmT& spm,
         Scalar prediction_error
     ) -> Matrix12x12 {
+        Matrix12x12 haze;
+        estimate_into(spm, prediction_error, haze);
+        return haze;
+    }
+
+    /**
+     * @brief Haze推定（ビンごとの予測誤差）
+     *
+     * 初回呼び出しで12×12のEMAフィールドを確保する（それまでのスカラーEMAを
+     * 全ビンに展開して引き継ぐ）。以後はスカラー版の estimate() もフィールドを更新する。
+     *
+     * @param spm Saliency Polar Map
+     * @param prediction_errors ビンごとの予測誤差 [0, 1]
+     * @return Hazeフィールド [0, 1]
+     */
+    template <typename SpmT>
+    auto estimate(
+        const SpmT& spm,
+        const Matrix12x12& prediction_errors
+    ) -> Matrix12x12 {
+        Matrix12x12 haze;
+        estimate_into(spm, prediction_errors, haze);
+        return haze;
+    }
+
+    /**
+     * @brief Haze推定（出力先へ直接書き込む）
+     *
+     * estimate() と同じ結果を haze に書く（エージェントの Haze フィールドなど、
+     * 戻り値のコピーなし）。haze は SPM と重ならないこと。
+     *
+     * @param spm Saliency Polar Map
+     * @param prediction_error 予測誤差 [0, 1]（スカラー、またはビンごとの Matrix12x12）
+     * @param haze 出力先（12×12、Matrix12x12 または Map）
+     */
+    template <typename SpmT, typename ErrorT, typename OutDerived>
+    void estimate_into(
+        const SpmT& spm,
+        const ErrorT& prediction_error,
+        Eigen::MatrixBase<OutDerived>& haze
+    ) {
+        update_ema(prediction_error);
+        estimate_from_ema(spm, haze);
+    }
+
+    /**
+     * @brief 予測誤差のEMA（フィールド保持時はその平均）
+     */
+    auto ema_error() const -> Scalar {
+        return ema_error_;
+    }
+
+    // ビンごとのEMAフィールドを保持しているか
+    auto has_ema_field() const -> bool {
+        return ema_field_.size() != 0;
+    }
+
+    // 平滑化に使う σ [ビン]（kBlurSigmas のいずれか）
+    auto blur_sigma() const -> Scalar {
+        return std::sqrt(static_cast<Scalar>(blur_order_)) / 2;
+    }
+
+    // EMA時定数
+    auto tau() const -> Scalar {
+        return tau_;
+    }
+
+    // 初回の estimate() 済みか（EMAが初期化済みか）
+    auto initialized() const -> bool {
+        return initialized_;
+    }
+
+    /**
+     * @brief スカラーEMAの1ステップ更新 α·e + (1-α)·EMA（α = 1/τ）
+     *
+     * estimate() の更新式そのもの。群のバッチ処理（swarm::HazeBatch）が
+     * 同じ式で全エージェントのEMAを更新するために公開する。
+     */
+    auto blend_ema(Scalar ema_error, Scalar prediction_error) const -> Scalar {
+        Scalar alpha = 1.0 / tau_;
+        return alpha * prediction_error + (1.0 - alpha) * ema_error;
+    }
+
+    /**
+     * @brief スカラーEMAを設定（初期化済みにする）
+     *
+     * 群のバッチ処理で更新したEMAを書き戻すために使う。EMAフィールドは保持しないこと。
+     */
+    void set_ema_error(Scalar ema_error) {
+        assert(!has_ema_field());
+        ema_error_ = ema_error;
+        initialized_ = true;
+    }
+
+    /**
+     * @brief スカラーEMAが ema_error のときのHazeフィールド（状態は変更しない）
+     *
+     * estimate_into() のEMA更新後の計算と同じ融合カーネル。群のバッチ処理で
+     * EMAを外部の連続配列に持つ場合に使う。
+     *
+     * @param spm Saliency Polar Map
+     * @param ema_error 予測誤差のEMA
+     * @param haze 出力先（12×12）
+     */
+    template <typename SpmT, typename OutDerived>
+    void haze_from_ema(const SpmT& spm, Scalar ema_error, Eigen::MatrixBase<OutDerived>& haze) const {
+        dispatch_blur(spm, ema_error, nullptr, haze);
+    }
+
+    /**
+     * @brief EMAフィルタリセット
+     */
+    void reset() {
+        ema_error_ = 0.0;
+        ema_field_.resize(0, 0);
+        initialized_ = false;
+    }
+
+private:
+    // EMA更新（スカラー予測誤差）
+    void update_ema(Scalar prediction_error) {
         using namespace eph::constants;
-        using namespace eph::math;
 
-        // EMA更新
         if (!initialized_) {
-            ema_error_ = Matrix12x12::Constant(prediction_error);
+            ema_error_ = prediction_error;
             initialized_ = true;
         } else {
+            if (has_ema_field()) {
+                Scalar alpha = 1.0 / tau_;
+                ema_field_ = alpha * EmaField::Constant(N_THETA, N_R, prediction_error) +
+                             (1.0 - alpha) * ema_field_;
+                ema_error_ = ema_field_.mean();
+            } else {
+                ema_error_ = blend_ema(ema_error_, prediction_error);
+            }
+        }
+    }
+
+    // EMA更新（ビンごとの予測誤差、EMAフィールドを確保）
+    void update_ema(const Matrix12x12& prediction_errors) {
+        using namespace eph::constants;
+
+        if (!initialized_) {
+            ema_field_ = prediction_errors;
+            initialized_ = true;
+        } else {
+            if (!has_ema_field()) {
+                ema_field_ = EmaField::Constant(N_THETA, N_R, ema_error_);
+            }
             Scalar alpha = 1.0 / tau_;
-            ema_error_ = alpha * Matrix12x12::Constant(prediction_error) +
-                         (1.0 - alpha) * ema_error_;
+            ema_field_ = alpha * prediction_errors + (1.0 - alpha) * ema_field_;
         }
+        ema_error_ = ema_field_.mean();
+    }
 
-        // チャネル取得
-        auto R1 = spm.get_channel(ChannelID::R1);  // 不確実性
-        auto F4 = spm.get_channel(ChannelID::F4);  // 可視性
-        auto F5 = spm.get_channel(ChannelID::F5);  // 観測安定性
+    // 現在のEMAからHazeフィールドを計算
+    template <typename SpmT, typename OutDerived>
+    void estimate_from_ema(const SpmT& spm, Eigen::MatrixBase<OutDerived>& haze) const {
+        dispatch_blur(spm, ema_error_, has_ema_field() ? &ema_field_ : nullptr, haze);
+    }
 
-        // 入力構成（§4.2の式）
-        Matrix12x12 input = HAZE_COEFF_A * ema_error_ +
-                            HAZE_COEFF_B * R1 +
-                            HAZE_COEFF_C * (Matrix12x12::Ones() - F4) +
-                            HAZE_COEFF_D * F5;
+    // 平滑化カーネルで分岐（ema_field が nullptr ならスカラーEMA）
+    template <typename SpmT, typename OutDerived>
+    void dispatch_blur(const SpmT& spm, Scalar ema_error, const EmaField* ema_field,
+                       Eigen::MatrixBase<OutDerived>& haze) const {
+        switch (blur_order_) {
+            case 4:  return fused_kernel<4>(spm, ema_error, ema_field, haze);
+            case 8:  return fused_kernel<8>(spm, ema_error, ema_field, haze);
+            case 16: return fused_kernel<16>(spm, ema_error, ema_field, haze);
+            case 2:
+            default: return fused_kernel<2>(spm, ema_error, ema_field, haze);
+        }
+    }
+
+    /**
+     * @brief 融合カーネル: EMA結合 → 線形結合 → Sigmoid → 平滑化
+     *
+     * SPMチャネルはビューのまま r 列単位で読み、12要素の列ごとに入力構成・
+     * クリッピング・Sigmoid をレジスタ上で済ませて平滑化前の値 h̃ に書く。
+     * 平滑化は近傍の列を読むため h̃ だけはスタック上の1枚（12×12、L1に収まる）
+     * に置き、平滑化の結果は出力先へ直接書く。中間の12×12フィールドは h̃ のみ
+     * （r 方向に分離する広いカーネルでは平滑化内の1枚を加えて2枚）。
+     *
+     * Sigmoid は平滑化が読む行（spm::blur::needed_row()）だけで評価する。読む行は
+     * θ 周期で連続し、列の先頭 kSweepHead 行と末尾 kSweepTail 行の2区間になる
+     * （半径1では死角の中央の行を飛ばす）。読まない行の h̃ は0。
+     */
+    template <int BlurOrder, typename SpmT, typename OutDerived>
+    static void fused_kernel(const SpmT& spm, Scalar ema_error, const EmaField* ema_field,
+                             Eigen::MatrixBase<OutDerived>& haze) {
+        using namespace eph::constants;
+        using namespace eph::math;
+        using Column = Eigen::Array<Scalar, N_THETA, 1>;
 
-        // 数値安定性: 入力クリッピング
-        input = input.cwiseMax(SIGMOID_CLIP_MIN).cwiseMin(SIGMOID_CLIP_MAX).eval();
+        // 死角は0
+        haze.template bottomRows<N_THETA - FovMask::kVisible>().setZero();
 
-        // Sigmoid適用
+        // 一様入力の高速経路（スカラーEMAは一様）
+        const auto r1_uniform = spm.uniform_value(ChannelID::R1);
+        const auto f4_uniform = spm.uniform_value(ChannelID::F4);
+        const auto f5_uniform = spm.uniform_value(ChannelID::F5);
+        if (!ema_field && r1_uniform && f4_uniform && f5_uniform) {
+            Scalar input = HAZE_COEFF_A * ema_error +
+                           HAZE_COEFF_B * *r1_uniform +
+                           HAZE_COEFF_C * (Scalar(1.0) - *f4_uniform) +
+                           HAZE_COEFF_D * *f5_uniform;
+            haze.template topRows<FovMask::kVisible>().setConstant(
+                blur_uniform<BlurOrder>(sigmoid<Mode>(input)));
+            return;
+        }
+
+        // チャネル取得（ゼロコピービュー）
+        const auto R1 = spm.channel(ChannelID::R1);  // 不確実性
+        const auto F4 = spm.channel(ChannelID::F4);  // 可視性
+        const auto F5 = spm.channel(ChannelID::F5);  // 観測安定性
+
+        // 入力構成（§4.2の式）→ 入力クリッピング + Sigmoid（r 列単位、平滑化が読む行のみ）
+        using Rows = SweepRows<BlurOrder>;
+        static_assert(Rows::matches_needed_rows(), "haze sweep rows must match the rows the blur reads");
         Matrix12x12 h_tilde;
-        for (int a = 0; a < N_THETA; ++a) {
+        if constexpr (Rows::kHead + Rows::kTail < N_THETA) {
+            h_tilde.template middleRows<N_THETA - Rows::kHead - Rows::kTail>(Rows::kHead).setZero();
+        }
+        auto sweep = [&](const auto& ema_column) {
             for (int b = 0; b < N_R; ++b) {
-                h_tilde(a, b) = sigmoid(input(a, b));
+                const auto ema = ema_column(b);
+                auto rows = [&](auto start, auto size) {
+                    constexpr int kStart = decltype(start)::value;
+                    constexpr int kSize = decltype(size)::value;
+                    if constexpr (kSize > 0) {
+                        h_tilde.col(b).template segment<kSize>(kStart) = sigmoid<Mode>(
+                            HAZE_COEFF_A * segment_of<kStart, kSize>(ema) +
+                            HAZE_COEFF_B * R1.col(b).template segment<kSize>(kStart).array() +
+                            HAZE_COEFF_C * (Scalar(1.0) - F4.col(b).template segment<kSize>(kStart).array()) +
+                            HAZE_COEFF_D * F5.col(b).template segment<kSize>(kStart).array()).matrix();
+                    }
+                };
+                rows(std::integral_constant<int, 0>{}, std::integral_constant<int, Rows::kHead>{});
+                rows(std::integral_constant<int, N_THETA - Rows::kTail>{},
+                     std::integral_constant<int, Rows::kTail>{});
             }
+        };
+        if (ema_field) {
+            sweep([&](int b) { return Eigen::Map<const Column>(ema_field->col(b).data()); });
+        } else {
+            sweep([&](int) { return ema_error; });
         }
 
-        // 空間平滑化
-        return gaussian_blur(h_tilde, 1.0);
+        // 空間平滑化（視野内の行を出力先へ）
+        gaussian_blur<BlurOrder>(h_tilde, haze);
     }
 
+    using FovMask = spm::FovMask<constants::N_THETA>;
+
     /**
-     * @brief EMAフィルタリセット
+     * @brief 平滑化が読む θ 行（視野内の行 + 周期で半径以内の死角行）
+     *
+     * 先頭 kHead 行と末尾 kTail 行。spm::blur::needed_row() と一致することを
+     * コンパイル時に確認する。
      */
-    void reset() {
-        ema_error_ = Matrix12x12::Zero();
-        initialized_ = false;
+    template <int BlurOrder>
+    struct SweepRows {
+        static constexpr int kRadius = spm::blur::Binomial<BlurOrder>::kRadius;
+        static constexpr int kHead = std::min(constants::N_THETA, FovMask::kVisible + kRadius);
+        static constexpr int kTail = std::min(kRadius, constants::N_THETA - kHead);
+
+        static constexpr auto matches_needed_rows() -> bool {
+            for (int a = 0; a < constants::N_THETA; ++a) {
+                const bool swept = a < kHead || a >= constants::N_THETA - kTail;
+                if (swept != spm::blur::needed_row<BlurOrder, constants::N_THETA, FovMask::kVisible>(a)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    // EMA列の行区間（スカラーEMAはそのまま）
+    template <int Start, int Size>
+    static auto segment_of(Scalar ema) -> Scalar {
+        return ema;
+    }
+
+    template <int Start, int Size, typename Derived>
+    static auto segment_of(const Eigen::DenseBase<Derived>& ema_column) {
+        return ema_column.template segment<Size>(Start);
+    }
+
+    // σ に最も近い対応カーネルの次数（σ² = 次数/4 の対数距離で比較）
+    static auto nearest_blur_order(Scalar sigma) -> int {
+        const Scalar order = 4 * sigma * sigma;
+        for (int i = 0; i + 1 < static_cast<int>(std::size(kBlurOrders)); ++i) {
+            // 隣接次数の幾何平均を境界にする
+            if (order * order < static_cast<Scalar>(kBlurOrders[i] * kBlurOrders[i + 1])) {
+                return kBlurOrders[i];
+            }
+        }
+        return kBlurOrders[std::size(kBlurOrders) - 1];
     }
 
-private:
     Scalar tau_;                  // EMA時定数
-    Matrix12x12 ema_error_;       // 予測誤差のEMA
+    Scalar ema_error_;            // 予測誤差のEMA（スカラー）
+    EmaField ema_field_;          // ビンごとの予測誤差のEMA（未使用時は空）
+    int blur_order_;              // 平滑化の二項カーネル次数
     bool initialized_;
 
     /**
      * @brief ガウシアンブラー（空間平滑化）
      *
-     * 簡易的な3×3ガウシアンカーネル（σ≈1）を使用:
+     * 二項係数カーネル（σ = √BlurOrder / 2）を θ 方向（周期）・r 方向
+     * （Neumann、端セル複製）の1次元パスに分けて適用する（spm::blur::separable()）。
+     * 視野内の行のみ出力する。
+     *
+     * 既定の BlurOrder = 2 は3×3カーネル
      * [1 2 1]
      * [2 4 2] / 16
      * [1 2 1]
+     * で、分離しても積和は9回→6回にしかならないため直接積和（spm::blur::direct()）
+     * のままとし、従来の結果とビット単位で一致させる。死角の行は書かない。
      *
      * @param input 入力フィールド
-     * @param sigma 標準偏差（未使用、拡張用）
-     * @return 平滑化されたフィールド
+     * @param output 出力先（視野内の行のみ書く）
      */
-    auto gaussian_blur(const Matrix12x12& input, Scalar sigma) const -> Matrix12x12 {
-        using namespace eph::constants;
-        using namespace eph::math;
-
-        Matrix12x12 output = Matrix12x12::Zero();
-
-        for (int a = 0; a < N_THETA; ++a) {
-            for (int b = 0; b < N_R; ++b) {
-                Scalar sum = 0.0;
-                Scalar weight_sum = 0.0;
-
-                for (int da = -1; da <= 1; ++da) {
-                    for (int db = -1; db <= 1; ++db) {
-                        int na = wrap_index(a + da, N_THETA);  // θ方向: 周期境界
-                        int nb = clamp_index(b + db, N_R);     // r方向: Neumann境界
-
-                        Scalar weight = (da == 0 && db == 0) ? 4.0 :
-                                       (da == 0 || db == 0) ? 2.0 : 1.0;
+    template <int BlurOrder, typename OutDerived>
+    static void gaussian_blur(const Matrix12x12& input, Eigen::MatrixBase<OutDerived>& output) {
+        if constexpr (BlurOrder == 2) {
+            spm::blur::direct<BlurOrder, FovMask::kVisible>(input, output);
+        } else {
+            spm::blur::separable<BlurOrder, FovMask::kVisible>(input, output);
+        }
+    }
 
-                        sum += weight * input(na, nb);
-                        weight_sum += weight;
-                    }
-                }
-                output(a, b) = sum / weight_sum;
-            }
+    // 定数フィールドの gaussian_blur()（解析解、一般経路とビット単位で一致）
+    template <int BlurOrder>
+    static auto blur_uniform(Scalar value) -> Scalar {
+        if constexpr (BlurOrder == 2) {
+            return spm::blur::uniform_direct<BlurOrder>(value);
+        } else {
+            return spm::blur::uniform_separable<BlurOrder>(value);
         }
-        return output;
     }
 };
 
+// 既定のHaze推定器（Sigmoid は厳密評価）
+using HazeEstimator = BasicHazeEstimator<math::SigmoidMode::Exact>;
+
+// 有理近似Sigmoidを使うHaze推定器（大規模群向け）
+using FastHazeEstimator = BasicHazeEstimator<math::SigmoidMode::Fast>;
+
 }  // namespace eph::agent
 
 #endif  // EPH_AGENT_HAZE_ESTIMATOR_HPP
@@ -0,0 +1,89 @@
+#ifndef EPH_AGENT_SPM_REPLAY_HPP
+#define EPH_AGENT_SPM_REPLAY_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "eph_core/types.hpp"
+#include "eph_spm/spm_recording.hpp"
+#include "eph_agent/eph_agent.hpp"
+
+namespace eph::agent {
+
+/**
+ * @brief 記録済みSPM系列でエージェントモデルを再生するドライバ
+ *
+ * SpmRecording（mmap）の各フレームを、コピーせずにエージェントの更新経路
+ * （EPHAgent::update → ActionSelector / HazeEstimator）へ流し込む。
+ * 群の生成・近傍探索・ラスタライズを省けるため、エージェントモデルの
+ * パラメータ調査（κ, Haze係数, 学習率など）を同じ知覚入力で繰り返し実行できる。
+ *
+ * エージェント i はフレームごとに記録のエージェント i のSPMを受け取る。
+ * 群レベルの処理（MB破れによる近傍hazeミキシング）は再生しない。
+ *
+ * ## 使用例
+ * ```cpp
+ * spm::SpmRecording recording("run.spm");
+ * std::vector<EPHAgent> agents(recording.n_agents(), EPHAgent(AgentState(), 1.0));
+ * SpmReplay(recording).run(agents, [](std::size_t frame, const std::vector<EPHAgent>& a) {
+ *     // 測定
+ * });
+ * ```
+ */
+class SpmReplay {
+public:
+    /**
+     * @param recording 再生する記録（SpmReplay より長く生存すること）
+     */
+    explicit SpmReplay(const spm::SpmRecording& recording)
+        : recording_(recording) {}
+
+    /**
+     * @brief 1フレーム分、全エージェントを更新
+     * @param frame フレーム番号
+     * @param agents 更新するエージェント（記録と同数）
+     * @param dt タイムステップ [s]
+     * @throws std::invalid_argument エージェント数が記録と異なる場合
+     */
+    void step(std::size_t frame, std::vector<EPHAgent>& agents, Scalar dt) const {
+        check_agent_count(agents);
+        for (std::size_t i = 0; i < agents.size(); ++i) {
+            agents[i].update(recording_.agent(frame, i), dt);
+        }
+    }
+
+    /**
+     * @brief 全フレームを記録時のタイムステップで順に再生
+     * @param agents 更新するエージェント（記録と同数）
+     * @param on_frame 各フレーム更新後に on_frame(frame, agents) を呼ぶ
+     * @throws std::invalid_argument エージェント数が記録と異なる場合
+     */
+    template <typename Observer>
+    void run(std::vector<EPHAgent>& agents, Observer&& on_frame) const {
+        check_agent_count(agents);
+        const auto dt = static_cast<Scalar>(recording_.dt());
+        for (std::size_t frame = 0; frame < recording_.n_frames(); ++frame) {
+            step(frame, agents, dt);
+            on_frame(frame, static_cast<const std::vector<EPHAgent>&>(agents));
+        }
+    }
+
+    void run(std::vector<EPHAgent>& agents) const {
+        run(agents, [](std::size_t, const std::vector<EPHAgent>&) {});
+    }
+
+    auto recording() const -> const spm::SpmRecording& { return recording_; }
+
+private:
+    const spm::SpmRecording& recording_;
+
+    void check_agent_count(const std::vector<EPHAgent>& agents) const {
+        if (agents.size() != recording_.n_agents()) {
+            throw std::invalid_argument("Agent count does not match the SPM recording");
+        }
+    }
+};
+
+}  // namespace eph::agent
+
+#endif  // EPH_AGENT_SPM_REPLAY_HPP
@@ -1,10 +1,23 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <vector>
 #include "eph_agent/action_selector.hpp"
 
 using namespace eph;
 using namespace eph::agent;
 
+namespace {
+
+// 丸め誤差の許容は Scalar の機械イプシロン基準（倍精度・単精度の両構成で同じテストを実行）
+constexpr Scalar kEps = std::numeric_limits<Scalar>::epsilon();
+
+// 中心差分の丸め誤差 ~ε|G|/h（倍精度では打ち切り誤差の許容 1e-6 に対して無視できる）
+constexpr double kFdRoundoff = 8.0 * kEps / constants::GRADIENT_EPSILON;
+
+}  // namespace
+
 // ===================================================================
 // カテゴリ1: EFE計算テスト（5テスト）
 // ===================================================================
@@ -163,7 +176,7 @@ TEST(ActionSelector, ComputeGradient_CentralDifference) {
 
     Vec2 v(1.0, 0.5);
 
-    // 中心差分（実装）
+    // 解析勾配（実装）
     Vec2 grad_central = ActionSelector::compute_efe_gradient(v, haze, spm, 0.0);
 
     // 片側差分（検証用）
@@ -173,10 +186,68 @@ TEST(ActionSelector, ComputeGradient_CentralDifference) {
     Scalar efe_0 = ActionSelector::compute_efe(v, haze, spm, 0.0);
     Scalar grad_forward_x = (efe_plus_x - efe_0) / GRADIENT_EPSILON;
 
-    // 中心差分と片側差分の値は近い（中心差分の方が精度高い）
+    // 解析勾配と片側差分の値は近い
     EXPECT_NEAR(grad_central.x(), grad_forward_x, 0.5);
 }
 
+TEST(ActionSelector, AnalyticGradient_MatchesFiniteDifference) {
+    Matrix12x12 haze = Matrix12x12::Constant(0.5);
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+
+    for (const Vec2& v : {Vec2(1.0, 0.5), Vec2(-0.3, 0.2), Vec2(0.0, -1.5)}) {
+        for (Scalar fatigue : {0.0, 0.4, 0.7}) {
+            const auto check = ActionSelector::check_efe_gradient(v, haze, spm, fatigue);
+            EXPECT_EQ(check.analytic, ActionSelector::compute_efe_gradient(v, haze, spm, fatigue));
+            EXPECT_LT(check.max_abs_error, 1e-6 + kFdRoundoff) << "v = " << v.transpose() << ", fatigue = " << fatigue;
+        }
+    }
+
+    // 原点では劣勾配 0（中心差分も対称性から 0）
+    EXPECT_EQ(ActionSelector::compute_efe_gradient(Vec2::Zero(), haze, spm, 0.0), Vec2::Zero());
+}
+
+namespace {
+
+// 勾配検証スイッチ（全スレッド共通の静的フラグ）をスコープ内だけ有効化する。
+// テストが途中で失敗・中断しても後続のテストに持ち越さない
+struct ScopedGradientVerification {
+    ScopedGradientVerification() { ActionSelector::set_gradient_verification(true); }
+    ~ScopedGradientVerification() { ActionSelector::set_gradient_verification(false); }
+    ScopedGradientVerification(const ScopedGradientVerification&) = delete;
+    ScopedGradientVerification& operator=(const ScopedGradientVerification&) = delete;
+};
+
+}  // namespace
+
+TEST(ActionSelector, GradientVerification_UsesFiniteDifferenceAndReports) {
+    Matrix12x12 haze = Matrix12x12::Constant(0.5);
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Ones());
+    const Vec2 v(0.8, -0.4);
+
+    const Vec2 analytic_step = ActionSelector::select_action(v, haze, spm, 0.2);
+    EXPECT_FALSE(ActionSelector::gradient_verification());
+
+    Vec2 verified_step;
+    ActionSelector::GradientVerificationReport report;
+    {
+        ScopedGradientVerification verification;
+        verified_step = ActionSelector::select_action(v, haze, spm, 0.2);
+        ActionSelector::select_action(v, haze, spm, 0.5);
+        report = ActionSelector::gradient_verification_report();
+    }
+    EXPECT_FALSE(ActionSelector::gradient_verification());
+
+    const Vec2 fd_step = ActionSelector::apply_constraints(
+        v - constants::LEARNING_RATE * ActionSelector::compute_efe_gradient_fd(v, haze, spm, 0.2), 0.2);
+    EXPECT_EQ(verified_step, fd_step);
+    EXPECT_NEAR((verified_step - analytic_step).norm(), 0.0, 1e-8 + constants::LEARNING_RATE * kFdRoundoff);
+    EXPECT_EQ(report.samples, 2u);
+    EXPECT_GT(report.max_abs_error, 0.0);
+    EXPECT_LT(report.max_abs_error, 1e-6 + kFdRoundoff);
+}
+
 // ===================================================================
 // カテゴリ3: 制約適用テスト（5テスト）
 // ===================================================================
@@ -319,3 +390,444 @@ TEST(ActionSelector, SelectAction_NoNaN) {
     EXPECT_FALSE(std::isinf(v_new.x()));
     EXPECT_FALSE(std::isinf(v_new.y()));
 }
+
+// ===================================================================
+// SoAバッチ
+// ===================================================================
+
+TEST(ActionSelector, SelectActionBatch_BitIdenticalToScalarPath) {
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    const Matrix12x12 haze = Matrix12x12::Constant(0.3);
+
+    // ブロック境界をまたぐ長さ + 分岐の全ケース（強制休息・ゼロ速度・上下限クリップ）
+    const Eigen::Index n = 2 * ActionSelector::kBatchBlock + 37;
+    ActionBatch batch;
+    batch.resize(n);
+    batch.vx = ActionBatch::Array::Random(n) * 3.0;
+    batch.vy = ActionBatch::Array::Random(n) * 3.0;
+    batch.fatigue = (ActionBatch::Array::Random(n) + 1.0) * 0.5;
+    batch.vx(0) = 0.0;  batch.vy(0) = 0.0;  batch.fatigue(0) = 0.1;
+    batch.vx(1) = 1e-9; batch.vy(1) = 0.0;  batch.fatigue(1) = 0.1;
+    batch.vx(2) = 0.02; batch.vy(2) = 0.01; batch.fatigue(2) = 0.0;
+    batch.vx(3) = 5.0;  batch.vy(3) = -5.0; batch.fatigue(3) = 0.0;
+    batch.vx(4) = 1.0;  batch.vy(4) = 1.0;  batch.fatigue(4) = 0.81;
+
+    std::vector<ActionSelection> expected(static_cast<size_t>(n));
+    for (Eigen::Index i = 0; i < n; ++i) {
+        expected[static_cast<size_t>(i)] = ActionSelector::select_action_with_efe(
+            Vec2(batch.vx(i), batch.vy(i)), haze, spm, batch.fatigue(i));
+    }
+
+    ActionSelector::select_action_batch(batch);
+
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const ActionSelection& e = expected[static_cast<size_t>(i)];
+        EXPECT_EQ(Vec2(batch.vx(i), batch.vy(i)), e.velocity) << "agent " << i;
+        EXPECT_EQ(batch.pragmatic(i), e.efe.pragmatic) << "agent " << i;
+    }
+}
+
+// ===================================================================
+// EFEの内訳
+// ===================================================================
+
+TEST(ActionSelector, SelectActionWithEfe_ReturnsEfeAtSelectedVelocity) {
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    const Matrix12x12 haze = Matrix12x12::Constant(0.4);
+    const Vec2 v(0.6, -0.3);
+    const Scalar fatigue = 0.2;
+
+    const ActionSelection selection = ActionSelector::select_action_with_efe(v, haze, spm, fatigue);
+
+    // 速度は select_action() と同一、EFE は返した速度での G(v_new)
+    EXPECT_EQ(selection.velocity, ActionSelector::select_action(v, haze, spm, fatigue));
+    EXPECT_EQ(selection.efe.total(), ActionSelector::compute_efe(selection.velocity, haze, spm, fatigue));
+    const Scalar expected_epistemic = Scalar(0.4) * spm.gradient_magnitude_mean(ChannelID::F2);
+    EXPECT_NEAR(selection.efe.epistemic, expected_epistemic, 4 * kEps * expected_epistemic);
+    EXPECT_DOUBLE_EQ(selection.efe.pragmatic,
+                     efe::FatigueCost::weight(fatigue) * selection.velocity.norm());
+    EXPECT_NE(selection.efe.pragmatic, efe::FatigueCost::weight(fatigue) * v.norm());
+}
+
+// ===================================================================
+// 候補サンプリング
+// ===================================================================
+
+TEST(ActionSelector, CandidateLattice_PolarGridWithinSpeedBounds) {
+    using namespace eph::constants;
+    const CandidateLattice lattice(8, 3, 0.25, 7);
+    ASSERT_EQ(lattice.size(), 24);
+
+    EXPECT_TRUE((lattice.speed() >= V_MIN).all());
+    EXPECT_TRUE((lattice.speed() <= V_MAX).all());
+    EXPECT_TRUE(((lattice.cos_angle().square() + lattice.sin_angle().square()) - 1.0).abs().maxCoeff() < 4 * kEps);
+
+    // 最低速・直進の候補は摂動しない
+    EXPECT_EQ(lattice.speed()(0), V_MIN);
+    EXPECT_EQ(lattice.cos_angle()(0), 1.0);
+    EXPECT_EQ(lattice.sin_angle()(0), 0.0);
+
+    // 同じシードなら同じ格子
+    const CandidateLattice again(8, 3, 0.25, 7);
+    EXPECT_TRUE((lattice.speed() == again.speed()).all());
+    EXPECT_TRUE((lattice.cos_angle() == again.cos_angle()).all());
+}
+
+TEST(ActionSelector, SelectActionSampled_PicksMinimumEfeCandidate) {
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    const Matrix12x12 haze = Matrix12x12::Constant(0.4);
+    const CandidateLattice lattice(12, 4, 0.3, 3);
+    const Vec2 v(0.3, 0.6);
+    const Scalar fatigue = 0.3;
+
+    const ActionSelection selection =
+        ActionSelector::select_action_sampled(v, haze, spm, fatigue, lattice);
+
+    // 全候補を総当たりした最小 EFE と一致
+    const Vec2 heading = v.normalized();
+    Scalar best = std::numeric_limits<Scalar>::infinity();
+    for (Eigen::Index i = 0; i < lattice.size(); ++i) {
+        best = std::min(best, ActionSelector::compute_efe(
+            lattice.candidate(i, heading.x(), heading.y()), haze, spm, fatigue));
+    }
+    EXPECT_NEAR(selection.efe.total(), best, 4 * kEps);
+    EXPECT_NEAR(selection.efe.total(),
+                ActionSelector::compute_efe(selection.velocity, haze, spm, fatigue), 4 * kEps);
+
+    // 高疲労 → 強制休息
+    const ActionSelection rest = ActionSelector::select_action_sampled(v, haze, spm, 0.9, lattice);
+    EXPECT_EQ(rest.velocity, Vec2::Zero());
+}
+
+TEST(ActionSelector, SelectActionSampledBatch_BitIdenticalToScalarPath) {
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    const Matrix12x12 haze = Matrix12x12::Constant(0.3);
+    const CandidateLattice lattice(16, 4, 0.25, 11);
+
+    const Eigen::Index n = 300;
+    ActionBatch batch;
+    batch.resize(n);
+    batch.vx = ActionBatch::Array::Random(n) * 2.0;
+    batch.vy = ActionBatch::Array::Random(n) * 2.0;
+    batch.fatigue = (ActionBatch::Array::Random(n) + 1.0) * 0.5;
+    batch.vx(0) = 0.0; batch.vy(0) = 0.0;
+    batch.epistemic.setConstant(ActionSelector::compute_epistemic(haze, spm));
+
+    std::vector<ActionSelection> expected(static_cast<size_t>(n));
+    for (Eigen::Index i = 0; i < n; ++i) {
+        expected[static_cast<size_t>(i)] = ActionSelector::select_action_sampled(
+            Vec2(batch.vx(i), batch.vy(i)), haze, spm, batch.fatigue(i), lattice);
+    }
+
+    ActionSelector::select_action_sampled_batch(batch, lattice);
+
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const ActionSelection& e = expected[static_cast<size_t>(i)];
+        EXPECT_EQ(Vec2(batch.vx(i), batch.vy(i)), e.velocity) << "agent " << i;
+        EXPECT_EQ(batch.pragmatic(i), e.efe.pragmatic) << "agent " << i;
+    }
+}
+
+// ===================================================================
+// EFE項の合成（BasicActionSelector<Terms...>）
+// ===================================================================
+
+namespace {
+
+// 巡航速度 v0 からのずれのコスト λ(|v| - v0)²（テスト用のPragmatic項）
+struct CruiseSpeed {
+    static constexpr bool kVelocityDependent = true;
+    static constexpr spm::ChannelMask kReadChannels = spm::kNoChannels;
+    static constexpr int kContextSize = 0;
+    static constexpr Scalar kLambda = 0.5;
+    static constexpr Scalar kCruise = 1.0;
+
+    template <typename C, typename F, typename VX, typename VY, typename S>
+    static auto value(const C& /*ctx*/, const F& /*fatigue*/, const VX& /*vx*/, const VY& /*vy*/, const S& speed) {
+        return kLambda * (speed - kCruise) * (speed - kCruise);
+    }
+
+    template <typename C, typename F, typename VX, typename VY, typename S>
+    static auto gradient_x(const C& /*ctx*/, const F& /*fatigue*/, const VX& vx, const VY& /*vy*/, const S& speed) {
+        return (Scalar(2.0) * kLambda * (speed - kCruise) / speed) * vx;
+    }
+
+    template <typename C, typename F, typename VX, typename VY, typename S>
+    static auto gradient_y(const C& /*ctx*/, const F& /*fatigue*/, const VX& /*vx*/, const VY& vy, const S& speed) {
+        return (Scalar(2.0) * kLambda * (speed - kCruise) / speed) * vy;
+    }
+};
+
+// 衝突リスクに応じた巡航速度 λ(|v| - v0(⟨F3⟩))²、v0 = V_MAX - (V_MAX - V_MIN)·min(⟨F3⟩, 1)
+// （v と SPM を結合するテスト用のPragmatic項。文脈量は v0）
+struct RiskCruise {
+    static constexpr bool kVelocityDependent = true;
+    static constexpr spm::ChannelMask kReadChannels = spm::kChannelMask<ChannelID::F3>;
+    static constexpr int kContextSize = 1;
+    static constexpr Scalar kLambda = 2.0;
+
+    template <typename SpmT>
+    static auto context(const Matrix12x12& /*haze*/, const SpmT& spm, int /*spm_level*/)
+        -> Eigen::Array<Scalar, 1, 1> {
+        using namespace eph::constants;
+        const Scalar risk = std::min(spm.channel_mean(ChannelID::F3), Scalar(1.0));
+        return Eigen::Array<Scalar, 1, 1>(V_MAX - (V_MAX - V_MIN) * risk);
+    }
+
+    template <typename C, typename F, typename VX, typename VY, typename S>
+    static auto value(const C& ctx, const F& /*fatigue*/, const VX& /*vx*/, const VY& /*vy*/, const S& speed) {
+        return kLambda * (speed - ctx(0)) * (speed - ctx(0));
+    }
+
+    template <typename C, typename F, typename VX, typename VY, typename S>
+    static auto gradient_x(const C& ctx, const F& /*fatigue*/, const VX& vx, const VY& /*vy*/, const S& speed) {
+        return (Scalar(2.0) * kLambda * (speed - ctx(0)) / speed) * vx;
+    }
+
+    template <typename C, typename F, typename VX, typename VY, typename S>
+    static auto gradient_y(const C& ctx, const F& /*fatigue*/, const VX& /*vx*/, const VY& vy, const S& speed) {
+        return (Scalar(2.0) * kLambda * (speed - ctx(0)) / speed) * vy;
+    }
+};
+
+// 衝突リスク ⟨F3⟩（テスト用のEpistemic項）
+struct MeanRisk {
+    static constexpr bool kVelocityDependent = false;
+    static constexpr spm::ChannelMask kReadChannels = spm::kChannelMask<ChannelID::F3>;
+
+    template <typename SpmT>
+    static auto value(const Matrix12x12& /*haze*/, const SpmT& spm, int /*spm_level*/) -> Scalar {
+        return spm.channel_mean(ChannelID::F3);
+    }
+};
+
+using ComposedSelector = BasicActionSelector<efe::HazeSaliency, MeanRisk, efe::FatigueCost, CruiseSpeed>;
+using CoupledSelector = BasicActionSelector<efe::HazeSaliency, efe::FatigueCost, RiskCruise>;
+
+// 視野内平均が ⟨F3⟩ = risk のSPM
+auto risk_spm(Scalar risk) -> spm::SaliencyPolarMap {
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    spm.set_channel(ChannelID::F3, Matrix12x12::Constant(risk));
+    return spm;
+}
+
+}  // namespace
+
+TEST(ActionSelector, ComposedTerms_SumValuesGradientsAndChannels) {
+    static_assert(ComposedSelector::kReadChannels == spm::kChannelMask<ChannelID::F2, ChannelID::F3>);
+
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    spm.set_channel(ChannelID::F3, Matrix12x12::Random().cwiseAbs());
+    const Matrix12x12 haze = Matrix12x12::Constant(0.3);
+    const Vec2 v(0.4, 0.9);
+    const Scalar fatigue = 0.2;
+
+    // 値: 既定構成 + 追加項
+    const Scalar cruise = CruiseSpeed::kLambda * (v.norm() - 1.0) * (v.norm() - 1.0);
+    const EfeTerms terms = ComposedSelector::compute_efe_terms(v, haze, spm, fatigue);
+    const EfeTerms base = ActionSelector::compute_efe_terms(v, haze, spm, fatigue);
+    EXPECT_NEAR(terms.epistemic, base.epistemic + spm.channel_mean(ChannelID::F3), 4 * kEps);
+    EXPECT_NEAR(terms.pragmatic, base.pragmatic + cruise, 4 * kEps);
+
+    // 勾配: 解析解の和が中心差分と一致
+    const auto check = ComposedSelector::check_efe_gradient(v, haze, spm, fatigue);
+    EXPECT_LT(check.max_abs_error, 1e-6 + kFdRoundoff);
+}
+
+TEST(ActionSelector, ComposedTerms_BatchMatchesScalarPath) {
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    spm.set_channel(ChannelID::F3, Matrix12x12::Random().cwiseAbs());
+    const Matrix12x12 haze = Matrix12x12::Constant(0.3);
+    const CandidateLattice lattice(12, 4);
+
+    const Eigen::Index n = ComposedSelector::kBatchBlock + 5;
+    ActionBatch batch;
+    batch.resize(n);
+    batch.vx = ActionBatch::Array::Random(n) * 2.0;
+    batch.vy = ActionBatch::Array::Random(n) * 2.0;
+    batch.fatigue = (ActionBatch::Array::Random(n) + 1.0) * 0.5;
+    batch.epistemic.setConstant(ComposedSelector::compute_epistemic(haze, spm));
+    ActionBatch sampled = batch;
+
+    std::vector<ActionSelection> expected(static_cast<size_t>(n));
+    std::vector<ActionSelection> expected_sampled(static_cast<size_t>(n));
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const Vec2 v(batch.vx(i), batch.vy(i));
+        expected[static_cast<size_t>(i)] =
+            ComposedSelector::select_action_with_efe(v, haze, spm, batch.fatigue(i));
+        expected_sampled[static_cast<size_t>(i)] =
+            ComposedSelector::select_action_sampled(v, haze, spm, batch.fatigue(i), lattice);
+    }
+
+    ComposedSelector::select_action_batch(batch);
+    ComposedSelector::select_action_sampled_batch(sampled, lattice);
+
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const auto k = static_cast<size_t>(i);
+        EXPECT_EQ(Vec2(batch.vx(i), batch.vy(i)), expected[k].velocity) << "agent " << i;
+        EXPECT_EQ(batch.pragmatic(i), expected[k].efe.pragmatic) << "agent " << i;
+        EXPECT_EQ(Vec2(sampled.vx(i), sampled.vy(i)), expected_sampled[k].velocity) << "agent " << i;
+    }
+}
+
+TEST(ActionSelector, ContextTerms_CoupleVelocityAndSpm) {
+    using namespace eph::constants;
+    static_assert(CoupledSelector::kContextSize == 1);
+    static_assert(CoupledSelector::kReadChannels == spm::kChannelMask<ChannelID::F2, ChannelID::F3>);
+
+    const spm::SaliencyPolarMap calm = risk_spm(0.0);
+    const spm::SaliencyPolarMap risky = risk_spm(0.75);
+    const Matrix12x12 haze = Matrix12x12::Constant(0.3);
+    const Vec2 v(0.6, 0.8);
+    const Scalar fatigue = 0.2;
+
+    // 文脈量: SPM から求めた巡航速度
+    EXPECT_EQ(CoupledSelector::compute_context(haze, calm)(0), V_MAX);
+    EXPECT_NEAR(CoupledSelector::compute_context(haze, risky)(0), V_MAX - 0.75 * (V_MAX - V_MIN), 1e-6);
+
+    // 値: 既定構成 + λ(|v| - v0)²
+    for (const spm::SaliencyPolarMap* spm : {&calm, &risky}) {
+        const Scalar v0 = CoupledSelector::compute_context(haze, *spm)(0);
+        const EfeTerms terms = CoupledSelector::compute_efe_terms(v, haze, *spm, fatigue);
+        const EfeTerms base = ActionSelector::compute_efe_terms(v, haze, *spm, fatigue);
+        EXPECT_EQ(terms.epistemic, base.epistemic);
+        EXPECT_NEAR(terms.pragmatic, base.pragmatic + RiskCruise::kLambda * (v.norm() - v0) * (v.norm() - v0),
+                    4 * kEps);
+
+        // 解析勾配（文脈量を通してSPMに依存）が中心差分と一致
+        const auto check = CoupledSelector::check_efe_gradient(v, haze, *spm, fatigue);
+        EXPECT_LT(check.max_abs_error, 1e-6 + kFdRoundoff);
+    }
+
+    // 同じ速度でもSPM（衝突リスク）で勾配の向きが変わる: 平穏なら加速、危険なら減速
+    const Vec2 g_calm = CoupledSelector::compute_efe_gradient(v, haze, calm, fatigue);
+    const Vec2 g_risky = CoupledSelector::compute_efe_gradient(v, haze, risky, fatigue);
+    EXPECT_LT(g_calm.dot(v), 0.0);
+    EXPECT_GT(g_risky.dot(v), 0.0);
+}
+
+TEST(ActionSelector, ContextTerms_BatchMatchesScalarPath) {
+    const std::vector<spm::SaliencyPolarMap> spms = {risk_spm(0.0), risk_spm(0.4), risk_spm(0.9)};
+    const Matrix12x12 haze = Matrix12x12::Constant(0.3);
+    const CandidateLattice lattice(12, 4);
+
+    const Eigen::Index n = CoupledSelector::kBatchBlock + 5;
+    ActionBatch batch;
+    batch.resize(n, CoupledSelector::kContextSize);
+    batch.vx = ActionBatch::Array::Random(n) * 2.0;
+    batch.vy = ActionBatch::Array::Random(n) * 2.0;
+    batch.fatigue = (ActionBatch::Array::Random(n) + 1.0) * 0.5;
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const auto& spm = spms[static_cast<size_t>(i) % spms.size()];
+        batch.epistemic(i) = CoupledSelector::compute_epistemic(haze, spm);
+        batch.context.row(i) = CoupledSelector::compute_context(haze, spm).transpose();
+    }
+    ActionBatch sampled = batch;
+
+    std::vector<ActionSelection> expected(static_cast<size_t>(n));
+    std::vector<ActionSelection> expected_sampled(static_cast<size_t>(n));
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const auto& spm = spms[static_cast<size_t>(i) % spms.size()];
+        const Vec2 v(batch.vx(i), batch.vy(i));
+        expected[static_cast<size_t>(i)] = CoupledSelector::select_action_with_efe(v, haze, spm, batch.fatigue(i));
+        expected_sampled[static_cast<size_t>(i)] =
+            CoupledSelector::select_action_sampled(v, haze, spm, batch.fatigue(i), lattice);
+    }
+
+    CoupledSelector::select_action_batch(batch);
+    CoupledSelector::select_action_sampled_batch(sampled, lattice);
+
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const auto k = static_cast<size_t>(i);
+        EXPECT_EQ(Vec2(batch.vx(i), batch.vy(i)), expected[k].velocity) << "agent " << i;
+        EXPECT_EQ(batch.pragmatic(i), expected[k].efe.pragmatic) << "agent " << i;
+        EXPECT_EQ(Vec2(sampled.vx(i), sampled.vy(i)), expected_sampled[k].velocity) << "agent " << i;
+        EXPECT_EQ(sampled.pragmatic(i), expected_sampled[k].efe.pragmatic) << "agent " << i;
+    }
+}
+
+TEST(ActionSelector, ContextTerms_SampledSelectionMinimizesFullEfe) {
+    using namespace eph::constants;
+    const CandidateLattice lattice(16, 20, 0.0);  // 速さの段の間隔 0.1 m/s
+    const Matrix12x12 haze = Matrix12x12::Constant(0.3);
+    const Vec2 v(1.0, 0.0);
+    const Scalar fatigue = 0.1;
+
+    Scalar previous_speed = std::numeric_limits<Scalar>::infinity();
+    for (const Scalar risk : {Scalar(0.0), Scalar(0.5), Scalar(1.0)}) {
+        const spm::SaliencyPolarMap spm = risk_spm(risk);
+        const ActionSelection selection = CoupledSelector::select_action_sampled(v, haze, spm, fatigue, lattice);
+
+        // 全候補の G（Epistemic + SPM と結合した Pragmatic）の最小
+        Scalar best = std::numeric_limits<Scalar>::infinity();
+        for (Eigen::Index i = 0; i < lattice.size(); ++i) {
+            best = std::min(best, CoupledSelector::compute_efe(lattice.candidate(i, 1.0, 0.0), haze, spm, fatigue));
+        }
+        EXPECT_EQ(selection.efe.total(), best) << "risk = " << risk;
+
+        // 衝突リスクが高いほど遅い候補（最低速の候補に張り付かない）
+        EXPECT_LT(selection.velocity.norm(), previous_speed) << "risk = " << risk;
+        previous_speed = selection.velocity.norm();
+    }
+
+    // リスク 0: 巡航速度 V_MAX と疲労コストの釣り合い |v| = V_MAX - κ/(2λ)
+    const Scalar kappa = efe::FatigueCost::weight(fatigue);
+    const ActionSelection calm = CoupledSelector::select_action_sampled(v, haze, risk_spm(0.0), fatigue, lattice);
+    EXPECT_NEAR(calm.velocity.norm(), V_MAX - kappa / (2.0 * RiskCruise::kLambda), 0.05 + 1e-6);
+}
+
+// ===================================================================
+// 反復勾配降下（Armijo直線探索）
+// ===================================================================
+
+TEST(ActionSelector, SelectActionLineSearch_ReachesEfeMinimumInOneCall) {
+    using namespace eph::constants;
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    const Matrix12x12 haze = Matrix12x12::Constant(0.4);
+    const Vec2 v(1.5, 0.6);
+    const Scalar fatigue = 0.2;
+
+    const ActionSelection selection =
+        ActionSelector::select_action_line_search(v, haze, spm, fatigue, DescentOptions{});
+
+    // G = const + κ|v| の制約付き最小点は |v| = V_MIN
+    EXPECT_NEAR(selection.velocity.norm(), V_MIN, 4 * kEps);
+    EXPECT_GE(selection.stats.iterations, 1);
+    EXPECT_LE(selection.stats.iterations, DescentOptions{}.max_iterations);
+    EXPECT_GE(selection.stats.evaluations, selection.stats.iterations);
+    EXPECT_NEAR(selection.efe.total(),
+                ActionSelector::compute_efe(selection.velocity, haze, spm, fatigue), 4 * kEps);
+
+    // 固定1ステップより G が小さい（以下）
+    const Vec2 one_step = ActionSelector::select_action(v, haze, spm, fatigue);
+    EXPECT_LE(selection.efe.total(), ActionSelector::compute_efe(one_step, haze, spm, fatigue));
+}
+
+TEST(ActionSelector, SelectActionLineSearch_RespectsIterationCapAndRest) {
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    const Matrix12x12 haze = Matrix12x12::Constant(0.4);
+
+    DescentOptions options;
+    options.max_iterations = 1;
+    options.initial_step = 0.1;
+    const ActionSelection capped =
+        ActionSelector::select_action_line_search(Vec2(1.5, 0.0), haze, spm, 0.0, options);
+    EXPECT_EQ(capped.stats.iterations, 1);
+    EXPECT_NEAR(capped.velocity.x(), Scalar(1.4), 4 * kEps);
+
+    // 高疲労 → 強制休息（反復しない）
+    const ActionSelection rest =
+        ActionSelector::select_action_line_search(Vec2(1.0, 0.0), haze, spm, 0.9, options);
+    EXPECT_EQ(rest.velocity, Vec2::Zero());
+    EXPECT_EQ(rest.stats.iterations, 0);
+    EXPECT_EQ(rest.stats.evaluations, 0);
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
+#include <bitset>
 #include <cmath>
 #include "eph_agent/eph_agent.hpp"
+#include "eph_spm/lazy_spm.hpp"
+#include "eph_spm/spm_batch.hpp"
 
 using namespace eph;
 using namespace eph::agent;
@@ -42,8 +45,8 @@ TEST(EPHAgent, Constructor_SetsKappaCorrectly) {
     EXPECT_DOUBLE_EQ(agent.state().position.x(), 1.0);
     EXPECT_DOUBLE_EQ(agent.state().position.y(), 2.0);
     EXPECT_DOUBLE_EQ(agent.state().velocity.x(), 0.5);
-    EXPECT_DOUBLE_EQ(agent.state().velocity.y(), -0.3);
-    EXPECT_DOUBLE_EQ(agent.state().fatigue, 0.2);
+    EXPECT_DOUBLE_EQ(agent.state().velocity.y(), Scalar(-0.3));
+    EXPECT_DOUBLE_EQ(agent.state().fatigue, Scalar(0.2));
 }
 
 // === Haze推定テスト ===
@@ -152,8 +155,8 @@ TEST(EPHAgent, StateAccess_ReturnsCorrectValues) {
     EXPECT_DOUBLE_EQ(state.position.y(), 4.0);
     EXPECT_DOUBLE_EQ(state.velocity.x(), 1.0);
     EXPECT_DOUBLE_EQ(state.velocity.y(), -1.0);
-    EXPECT_DOUBLE_EQ(state.kappa, 1.2);  // コンストラクタで上書き
-    EXPECT_DOUBLE_EQ(state.fatigue, 0.3);
+    EXPECT_DOUBLE_EQ(state.kappa, Scalar(1.2));  // コンストラクタで上書き
+    EXPECT_DOUBLE_EQ(state.fatigue, Scalar(0.3));
 }
 
 TEST(EPHAgent, HazeAccess_ReturnsCurrentHaze) {
@@ -235,3 +238,126 @@ TEST(EPHAgent, EstimateHaze_NeverProducesNaN) {
         }
     }
 }
+
+// === SpmBatchビューテスト ===
+
+TEST(EPHAgent, Update_WithBatchView_MatchesSaliencyPolarMap) {
+    AgentState initial_state(Vec2(0.0, 0.0), Vec2(0.5, 0.2), 1.0, 0.0);
+    EPHAgent agent_map(initial_state, 1.0);
+    EPHAgent agent_view(initial_state, 1.0);
+
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    spm.set_channel(ChannelID::R1, Matrix12x12::Random().cwiseAbs());
+    spm.set_channel(ChannelID::F4, Matrix12x12::Constant(0.5));
+
+    spm::SpmBatch batch(1);
+    batch.agent(0).assign(spm);
+    const spm::SpmBatch& cbatch = batch;
+
+    for (int t = 0; t < 20; ++t) {
+        agent_map.update(spm, 0.1);
+        agent_view.update(cbatch.agent(0), 0.1);
+    }
+
+    // 同一入力 → ビット一致
+    EXPECT_EQ(agent_map.state().velocity, agent_view.state().velocity);
+    EXPECT_EQ(agent_map.state().position, agent_view.state().position);
+    EXPECT_EQ(agent_map.haze(), agent_view.haze());
+}
+
+// === SPMピラミッド段 ===
+
+TEST(EPHAgent, SpmLevel_SelectsActionOnCoarseLevel) {
+    AgentState initial_state(Vec2(0.0, 0.0), Vec2(0.5, 0.2), 1.0, 0.0);
+    EPHAgent agent(initial_state, 1.0);
+    EXPECT_EQ(agent.spm_level(), 0);
+
+    agent.set_spm_level(7);
+    EXPECT_EQ(agent.spm_level(), spm::SaliencyPolarMap::kPyramidLevels - 1);
+    agent.set_spm_level(1);
+    EXPECT_EQ(agent.spm_level(), 1);
+
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    agent.set_effective_haze(Matrix12x12::Constant(0.4));
+
+    const Vec2 expected = ActionSelector::select_action(
+        initial_state.velocity, agent.haze(), spm, initial_state.fatigue, 1);
+    agent.update(spm, 0.1);
+
+    EXPECT_EQ(agent.state().velocity, expected);
+}
+
+// === EFE記録 ===
+
+TEST(EPHAgent, Update_RecordsEfeOfSelectedAction) {
+    AgentState initial_state(Vec2(0.0, 0.0), Vec2(0.5, 0.2), 1.0, 0.1);
+    EPHAgent agent(initial_state, 1.0);
+    EXPECT_EQ(agent.efe().total(), 0.0);
+
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    spm.set_channel(ChannelID::R1, Matrix12x12::Random().cwiseAbs());
+    agent.set_effective_haze(Matrix12x12::Constant(0.4));
+
+    for (int t = 0; t < 3; ++t) {
+        const Matrix12x12 haze = agent.haze();
+        const Scalar fatigue = agent.state().fatigue;
+        agent.update(spm, 0.1);
+
+        // 選んだ速度での G（Haze・疲労度は行為選択時の値）
+        const EfeTerms expected =
+            ActionSelector::compute_efe_terms(agent.state().velocity, haze, spm, fatigue);
+        EXPECT_EQ(agent.efe().epistemic, expected.epistemic);
+        EXPECT_EQ(agent.efe().pragmatic, expected.pragmatic);
+    }
+}
+
+// === 要求チャネルの遅延生成 ===
+
+TEST(EPHAgent, Update_WithLazySpm_EvaluatesOnlyReadChannels) {
+    AgentState initial_state(Vec2(0.0, 0.0), Vec2(0.5, 0.2), 1.0, 0.0);
+    EPHAgent agent_map(initial_state, 1.0);
+    EPHAgent agent_lazy(initial_state, 1.0);
+
+    spm::SaliencyPolarMap inputs;
+    inputs.set_channel(ChannelID::F0, (Matrix12x12::Random().array() > 0.5).cast<Scalar>().matrix());
+    inputs.set_channel(ChannelID::F2, Matrix12x12::Random());
+    inputs.set_channel(ChannelID::R1, Matrix12x12::Random().cwiseAbs());
+    inputs.set_channel(ChannelID::F4, Matrix12x12::Constant(0.5));
+
+    int produced = 0;
+    auto lazy = spm::make_lazy_spm<EPHAgent::kReadChannels>(
+        [&](ChannelID id, spm::SaliencyPolarMap& map) {
+            ++produced;
+            map.set_channel(id, inputs.get_channel(id));
+        });
+
+    spm::SaliencyPolarMap spm;
+    for (ChannelID id : {ChannelID::F2, ChannelID::R1, ChannelID::F4}) {
+        spm.set_channel(id, inputs.get_channel(id));
+    }
+
+    for (int t = 0; t < 5; ++t) {
+        spm.begin_frame();
+        spm.set_channel(ChannelID::F0, inputs.get_channel(ChannelID::F0));
+        spm.update_temporal();
+        agent_map.update(spm, 0.1);
+
+        lazy.begin_frame();
+        agent_lazy.update(lazy, 0.1);
+    }
+
+    // 宣言した集合（と依存）の内側で、読まれたチャネルのみフレームごとに1回ずつ生成
+    const auto generated = lazy.evaluated() & ~spm::kChannelMask<ChannelID::R0, ChannelID::F5>;
+    EXPECT_EQ(lazy.evaluated() & ~spm::with_dependencies(EPHAgent::kReadChannels) &
+                  ~spm::channel_bit(ChannelID::R0),
+              spm::kNoChannels);
+    EXPECT_TRUE(spm::contains(generated, ChannelID::F0));
+    EXPECT_TRUE(spm::contains(generated, ChannelID::R1));
+    EXPECT_TRUE(spm::contains(generated, ChannelID::F4));
+    EXPECT_EQ(produced, 5 * static_cast<int>(std::bitset<32>(generated).count()));
+    EXPECT_EQ(agent_map.state().velocity, agent_lazy.state().velocity);
+    EXPECT_EQ(agent_map.haze(), agent_lazy.haze());
+}
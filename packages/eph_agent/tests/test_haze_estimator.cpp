@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include <cmath>
+#include <limits>
+#include <vector>
 #include "eph_agent/haze_estimator.hpp"
+#include "eph_spm/spm_batch.hpp"
 
 using namespace eph;
 using namespace eph::agent;
@@ -211,3 +214,214 @@ TEST(HazeEstimator, NumericalStability_ExtremeInputs) {
         }
     }
 }
+
+// === 視野マスクテスト ===
+
+TEST(HazeEstimator, FovMask_BlindSpotIsZero) {
+    HazeEstimator estimator(1.0);
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::R1, Matrix12x12::Constant(0.8));
+
+    auto haze = estimator.estimate(spm, 0.5);
+
+    constexpr int kVisible = spm::FovMask<12>::kVisible;
+    EXPECT_DOUBLE_EQ(haze.bottomRows<12 - kVisible>().norm(), 0.0);
+    EXPECT_GT(haze.topRows<kVisible>().minCoeff(), 0.0);
+}
+
+TEST(HazeEstimator, FovMask_VisibleHazeUsesOnlyAdjacentBlindRows) {
+    Matrix12x12 base = Matrix12x12::Random() * 0.5 + Matrix12x12::Constant(0.5);
+
+    auto estimate_with = [&](const Matrix12x12& r1) {
+        HazeEstimator estimator(1.0);
+        spm::SaliencyPolarMap spm;
+        spm.set_channel(ChannelID::R1, r1);
+        return Matrix12x12(estimator.estimate(spm, 0.5));
+    };
+    const Matrix12x12 reference = estimate_with(base);
+
+    // 視野から離れた死角行（a = 10）は視野内の平滑化に影響しない
+    Matrix12x12 far = base;
+    far.row(10).setConstant(1.0);
+    EXPECT_EQ(estimate_with(far), reference);
+
+    // 視野に隣接する死角行（a = 9）は周期近傍として視野端 a = 8 に効く
+    Matrix12x12 adjacent = base;
+    adjacent.row(9).setConstant(1.0);
+    const Matrix12x12 perturbed = estimate_with(adjacent);
+    EXPECT_NE(perturbed.row(8), reference.row(8));
+    EXPECT_EQ(perturbed.topRows<8>(), reference.topRows<8>());
+}
+
+// === 一様チャネル高速経路テスト ===
+
+TEST(HazeEstimator, UniformChannels_MatchGeneralPath) {
+    // 一様フラグを持つマップ（高速経路）と持たないバッチビュー（一般経路）で比較
+    // 高速経路はスカラー sigmoid()、一般経路は配列の SIMD exp のため数 ULP 以内で一致
+    const Scalar tolerance = 8 * std::numeric_limits<Scalar>::epsilon();
+    spm::SaliencyPolarMap map;
+    map.fill_channel(ChannelID::R1, 0.3);
+    map.fill_channel(ChannelID::F4, 0.6);
+    map.fill_channel(ChannelID::F5, 0.1);
+    ASSERT_TRUE(map.uniform_value(ChannelID::R1).has_value());
+
+    spm::SpmBatch batch(1);
+    batch.agent(0).assign(map);
+
+    HazeEstimator fast(2.0);
+    HazeEstimator general(2.0);
+    for (Scalar error : {0.4, 0.9, 0.0}) {
+        const Matrix12x12 h_fast = fast.estimate(map, error);
+        const Matrix12x12 h_general = general.estimate(batch.agent(0), error);
+        EXPECT_LE((h_fast - h_general).cwiseAbs().maxCoeff(), tolerance);
+    }
+}
+
+TEST(HazeEstimator, UniformChannels_MatchGeneralPath_WideBlur) {
+    const Scalar tolerance = 8 * std::numeric_limits<Scalar>::epsilon();
+    spm::SaliencyPolarMap map;
+    map.fill_channel(ChannelID::R1, 0.3);
+    map.fill_channel(ChannelID::F4, 0.6);
+    map.fill_channel(ChannelID::F5, 0.1);
+
+    spm::SpmBatch batch(1);
+    batch.agent(0).assign(map);
+
+    HazeEstimator fast(2.0, 2.0);
+    HazeEstimator general(2.0, 2.0);
+    EXPECT_LE((fast.estimate(map, 0.4) - general.estimate(batch.agent(0), 0.4)).cwiseAbs().maxCoeff(), tolerance);
+}
+
+// === 平滑化の幅 ===
+
+TEST(HazeEstimator, BlurSigma_RoundsToSupportedKernel) {
+    EXPECT_DOUBLE_EQ(HazeEstimator().blur_sigma(), HazeEstimator::kDefaultBlurSigma);
+    EXPECT_DOUBLE_EQ(HazeEstimator(1.0, 1.0).blur_sigma(), 1.0);
+    EXPECT_DOUBLE_EQ(HazeEstimator(1.0, 1.1).blur_sigma(), 1.0);
+    EXPECT_NEAR(HazeEstimator(1.0, 1.5).blur_sigma(), std::sqrt(2.0), std::numeric_limits<Scalar>::epsilon());
+    EXPECT_DOUBLE_EQ(HazeEstimator(1.0, 5.0).blur_sigma(), 2.0);
+    EXPECT_DOUBLE_EQ(HazeEstimator(1.0, 0.1).blur_sigma(), HazeEstimator::kDefaultBlurSigma);
+}
+
+TEST(HazeEstimator, WiderBlur_SpreadsPeakFurther) {
+    spm::SaliencyPolarMap spm;
+    Matrix12x12 R1 = Matrix12x12::Zero();
+    R1(4, 6) = 1.0;
+    spm.set_channel(ChannelID::R1, R1);
+    spm.set_channel(ChannelID::F4, Matrix12x12::Ones());
+    spm.set_channel(ChannelID::F5, Matrix12x12::Zero());
+
+    HazeEstimator narrow(1.0);
+    HazeEstimator wide(1.0, 2.0);
+    const Matrix12x12 h_narrow = narrow.estimate(spm, 0.0);
+    const Matrix12x12 h_wide = wide.estimate(spm, 0.0);
+
+    // 3×3 の外（距離 3）には狭いカーネルでは届かず、広いカーネルでは届く
+    const Scalar floor = h_narrow(0, 0);
+    EXPECT_DOUBLE_EQ(h_narrow(4, 9), floor);
+    EXPECT_GT(h_wide(4, 9), floor);
+    EXPECT_LT(h_wide(4, 6), h_narrow(4, 6));
+}
+
+// === Sigmoid 精度モード ===
+
+TEST(HazeEstimator, FastSigmoid_CloseToExact) {
+    static_assert(HazeEstimator::kSigmoidMode == math::SigmoidMode::Exact);
+    static_assert(FastHazeEstimator::kSigmoidMode == math::SigmoidMode::Fast);
+
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::R1, Matrix12x12::Random() * 0.5 + Matrix12x12::Constant(0.5));
+    spm.set_channel(ChannelID::F4, Matrix12x12::Random() * 0.5 + Matrix12x12::Constant(0.5));
+    spm.set_channel(ChannelID::F5, Matrix12x12::Random() * 0.5 + Matrix12x12::Constant(0.5));
+
+    HazeEstimator exact(2.0);
+    FastHazeEstimator fast(2.0);
+    for (Scalar error : {0.3, 0.8}) {
+        const Matrix12x12 h_exact = exact.estimate(spm, error);
+        const Matrix12x12 h_fast = fast.estimate(spm, error);
+        // 平滑化は凸結合なので誤差は Sigmoid の最大誤差（+ Exact の配列 exp の丸め）以下
+        EXPECT_LE((h_exact - h_fast).cwiseAbs().maxCoeff(),
+                  math::SIGMOID_FAST_MAX_ERROR + 4 * std::numeric_limits<Scalar>::epsilon());
+    }
+}
+
+TEST(HazeEstimator, FastSigmoid_UniformMatchesGeneralPathExactly) {
+    spm::SaliencyPolarMap map;
+    map.fill_channel(ChannelID::R1, 0.3);
+    map.fill_channel(ChannelID::F4, 0.6);
+    map.fill_channel(ChannelID::F5, 0.1);
+
+    spm::SpmBatch batch(1);
+    batch.agent(0).assign(map);
+
+    FastHazeEstimator fast(2.0);
+    FastHazeEstimator general(2.0);
+    EXPECT_EQ(fast.estimate(map, 0.4), general.estimate(batch.agent(0), 0.4));
+}
+
+// === 出力先への直接書き込み ===
+
+TEST(HazeEstimator, EstimateInto_WritesSameFieldInPlace) {
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::R1, Matrix12x12::Random() * 0.5 + Matrix12x12::Constant(0.5));
+    spm.set_channel(ChannelID::F4, Matrix12x12::Random() * 0.5 + Matrix12x12::Constant(0.5));
+
+    HazeEstimator reference(2.0, 1.0);
+    HazeEstimator in_place(2.0, 1.0);
+
+    // 連続バッファ内の1エージェント分（Map）へ書く。死角行も上書きされる
+    std::vector<Scalar> storage(2 * 144, -1.0);
+    Eigen::Map<Matrix12x12> haze(storage.data() + 144);
+
+    Matrix12x12 per_bin = Matrix12x12::Constant(0.2);
+    per_bin(3, 4) = 0.9;
+    for (int step = 0; step < 3; ++step) {
+        in_place.estimate_into(spm, 0.4, haze);
+        EXPECT_EQ(Matrix12x12(haze), reference.estimate(spm, 0.4));
+    }
+    in_place.estimate_into(spm, per_bin, haze);
+    EXPECT_EQ(Matrix12x12(haze), reference.estimate(spm, per_bin));
+    EXPECT_EQ(storage[0], -1.0);  // 出力先の外は書かない
+}
+
+// === EMA状態 ===
+
+TEST(HazeEstimator, ScalarEma_NoPerBinStorageUntilFieldSupplied) {
+    HazeEstimator estimator(2.0);
+    EXPECT_LT(sizeof(HazeEstimator), sizeof(Matrix12x12));
+
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::R1, Matrix12x12::Random().cwiseAbs());
+    spm.set_channel(ChannelID::F4, Matrix12x12::Constant(0.5));
+
+    estimator.estimate(spm, 0.8);
+    estimator.estimate(spm, 0.2);
+    EXPECT_FALSE(estimator.has_ema_field());
+    EXPECT_DOUBLE_EQ(estimator.ema_error(), 0.5 * 0.2 + 0.5 * 0.8);
+
+    // 一様なビンごとの誤差 = スカラー版（EMAフィールドはここで確保）
+    HazeEstimator scalar_path(2.0);
+    scalar_path.estimate(spm, 0.8);
+    scalar_path.estimate(spm, 0.2);
+    const Matrix12x12 expected = scalar_path.estimate(spm, 0.6);
+    const Matrix12x12 haze = estimator.estimate(spm, Matrix12x12::Constant(0.6));
+    EXPECT_TRUE(estimator.has_ema_field());
+    EXPECT_TRUE(haze.isApprox(expected, 1e-12));
+
+    // リセットでスカラーに戻る
+    estimator.reset();
+    EXPECT_FALSE(estimator.has_ema_field());
+}
+
+TEST(HazeEstimator, PerBinErrors_RaiseHazeOnlyWhereErrorIsHigh) {
+    HazeEstimator estimator(1.0);
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F4, Matrix12x12::Ones());
+
+    Matrix12x12 errors = Matrix12x12::Zero();
+    errors.col(11).setOnes();
+    const Matrix12x12 haze = estimator.estimate(spm, errors);
+
+    EXPECT_GT(haze(4, 11), haze(4, 0));
+    EXPECT_DOUBLE_EQ(estimator.ema_error(), errors.mean());
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "eph_agent/spm_replay.hpp"
+#include "eph_spm/spm_batch.hpp"
+
+using namespace eph;
+using namespace eph::agent;
+
+namespace {
+
+std::vector<EPHAgent> make_agents(size_t n) {
+    std::vector<EPHAgent> agents;
+    for (size_t i = 0; i < n; ++i) {
+        AgentState state(Vec2(0.0, 0.0), Vec2(0.5 + 0.1 * i, 0.2), 1.0, 0.0);
+        agents.emplace_back(state, 0.5 + 0.2 * i);
+    }
+    return agents;
+}
+
+}  // namespace
+
+TEST(SpmReplay, Run_MatchesLiveUpdatePath) {
+    const std::string path = ::testing::TempDir() + "replay.spm";
+    const size_t n = 3;
+    const Scalar dt = 0.1;
+
+    // 記録しながら直接更新（参照）
+    auto live = make_agents(n);
+    spm::SpmBatch perception(n);
+    {
+        spm::SpmRecorder recorder(path, n, dt);
+        for (int t = 0; t < 20; ++t) {
+            for (size_t i = 0; i < n; ++i) {
+                perception.agent(i).set_channel(ChannelID::F2, Matrix12x12::Random() * 0.5 + Matrix12x12::Constant(0.5));
+                perception.agent(i).set_channel(ChannelID::R1, Matrix12x12::Random().cwiseAbs());
+            }
+            recorder.append_frame(perception);
+            for (size_t i = 0; i < n; ++i) {
+                live[i].update(perception.agent(i), dt);
+            }
+        }
+    }
+
+    // 記録から再生
+    spm::SpmRecording recording(path);
+    auto replayed = make_agents(n);
+    size_t frames_seen = 0;
+    SpmReplay(recording).run(replayed, [&](size_t frame, const std::vector<EPHAgent>&) {
+        EXPECT_EQ(frame, frames_seen++);
+    });
+    EXPECT_EQ(frames_seen, 20u);
+
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(replayed[i].state().velocity, live[i].state().velocity);
+        EXPECT_EQ(replayed[i].state().position, live[i].state().position);
+        EXPECT_EQ(replayed[i].haze(), live[i].haze());
+    }
+    std::remove(path.c_str());
+}
+
+TEST(SpmReplay, Step_RejectsAgentCountMismatch) {
+    const std::string path = ::testing::TempDir() + "replay_count.spm";
+    {
+        spm::SpmRecorder recorder(path, 2, 0.1);
+        recorder.append_frame(spm::SpmBatch(2));
+    }
+    spm::SpmRecording recording(path);
+    auto agents = make_agents(3);
+    EXPECT_THROW(SpmReplay(recording).step(0, agents, 0.1), std::invalid_argument);
+    std::remove(path.c_str());
+}
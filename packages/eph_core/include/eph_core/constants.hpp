@@ -26,6 +26,14 @@ constexpr Scalar FIELD_OF_VIEW_RADIANS = FIELD_OF_VIEW_DEGREES * PI / 180.0;
 static_assert(FIELD_OF_VIEW_DEGREES > 0.0 && FIELD_OF_VIEW_DEGREES <= 360.0,
               "Field of view must be in range (0°, 360°]");
 
+// SPM知覚パラメータ（appendix B §5）
+constexpr Scalar SPM_PERCEPTION_RADIUS = 3.0;   // 知覚半径 r_max [m]（rビンは [0, r_max) を線形分割）
+constexpr int SPM_MAX_NEIGHBORS = 32;           // 1エージェントが知覚する最大近傍数（近い順）
+constexpr Scalar MOTION_PRESSURE_ALPHA = 1.0;   // F1 ゲイン α
+constexpr Scalar MOTION_PRESSURE_EPS = 0.1;     // F1 距離正則化 ε [m]
+constexpr Scalar TTC_EPS = 0.1;                 // F3 TTC ≈ r / (v_in + ε) の ε [m/s]
+constexpr int F5_STABILITY_WINDOW = 5;          // F5 観測安定性の窓長 w [step]
+
 // EPH理論定数
 constexpr Scalar BETA_C_TYPICAL = 0.098;  // 臨界点
 
@@ -39,6 +47,10 @@ constexpr Scalar HAZE_COEFF_D = 0.1;  // 観測不安定性の重み
 constexpr Scalar EPS = 1e-6;                  // ゼロ除算防止
 constexpr Scalar SIGMOID_CLIP_MIN = -10.0;    // Sigmoid飽和防止
 constexpr Scalar SIGMOID_CLIP_MAX = 10.0;
+// 状態しきい値（強制休息の疲労度・移動判定の速さ）の判定マージン。疲労度は一定量ずつ
+// 増減し、速さは V_MIN にクリップされるため、しきい値ちょうどの値が丸め誤差で
+// 精度（float/double）ごとに異なる側へ判定されないようにする（1ステップの変化量より十分小さい）
+constexpr Scalar THRESHOLD_MARGIN = 1e-4;
 
 // Phase 4: 行為選択パラメータ
 constexpr Scalar V_MIN = 0.1;           // 最小速度 [m/s]
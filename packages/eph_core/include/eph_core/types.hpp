@@ -1,16 +1,30 @@
 #ifndef EPH_CORE_TYPES_HPP
 #define EPH_CORE_TYPES_HPP
 
+// Eigen の float 版SIMD sqrt は既定（EIGEN_FAST_MATH=1）で rsqrt 近似となり、std::sqrt と
+// 丸めが異なる。配列演算のバッチ経路とスカラー経路を一致させるため正しく丸める版を使う
+// （CMake ターゲット eph_core が定義する。ここでの既定はこのヘッダーを Eigen より先に
+// インクルードした場合のみ有効）
+#ifndef EIGEN_FAST_MATH
+#define EIGEN_FAST_MATH 0
+#endif
+
 #include <Eigen/Core>
 #include <unsupported/Eigen/CXX11/Tensor>
 
 namespace eph {
 
 // スカラー型（全プロジェクト統一）
+// EPH_SINGLE_PRECISION 定義時は float32 構成（CMakeオプション EPH_SINGLE_PRECISION）。
+// EPH_FORCE_DOUBLE_PRECISION は単精度構成の比較用に倍精度を強制する（精度ドリフト検証用）。
+#if defined(EPH_SINGLE_PRECISION) && !defined(EPH_FORCE_DOUBLE_PRECISION)
+using Scalar = float;
+#else
 using Scalar = double;
+#endif
 
 // ベクトル型
-using Vec2 = Eigen::Vector2d;
+using Vec2 = Eigen::Matrix<Scalar, 2, 1>;
 
 // テンソル型
 using Tensor3 = Eigen::Tensor<Scalar, 3>;
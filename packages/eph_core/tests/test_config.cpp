@@ -9,8 +9,8 @@ TEST(Config, AgentConfig_DefaultValues) {
 
     EXPECT_DOUBLE_EQ(config.kappa, 1.0);
     EXPECT_DOUBLE_EQ(config.mass, 1.0);
-    EXPECT_DOUBLE_EQ(config.drag_coeff, 0.1);
-    EXPECT_DOUBLE_EQ(config.eta, 0.1);
+    EXPECT_DOUBLE_EQ(config.drag_coeff, Scalar(0.1));
+    EXPECT_DOUBLE_EQ(config.eta, Scalar(0.1));
     EXPECT_DOUBLE_EQ(config.tau_haze, 1.0);
 }
 
@@ -19,8 +19,8 @@ TEST(Config, SwarmConfig_DefaultValues) {
     SwarmConfig config;
 
     EXPECT_EQ(config.n_agents, 100);
-    EXPECT_DOUBLE_EQ(config.beta, 0.098);
-    EXPECT_DOUBLE_EQ(config.dt, 0.1);
+    EXPECT_DOUBLE_EQ(config.beta, Scalar(0.098));
+    EXPECT_DOUBLE_EQ(config.dt, Scalar(0.1));
     EXPECT_EQ(config.neighbor_count, 6);
     EXPECT_TRUE(config.use_role_distribution);
 }
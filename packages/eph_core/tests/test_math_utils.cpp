@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <cmath>
+#include <limits>
 #include "eph_core/math_utils.hpp"
 #include "eph_core/constants.hpp"
 
@@ -67,6 +68,33 @@ TEST(MathUtils, Sigmoid_MonotonicallyIncreasing) {
     EXPECT_LT(sigmoid(0.0), sigmoid(1.0));
 }
 
+TEST(MathUtils, SigmoidArray_Exact_MatchesScalarWithinUlps) {
+    // 配列版は SIMD exp（std::exp と数 ULP 異なりうる）: 相対 4 ULP 未満
+    const Scalar ulp = std::numeric_limits<Scalar>::epsilon();
+    Eigen::Array<Scalar, 12, 12> x = Eigen::Array<Scalar, 12, 12>::Random() * 15.0;
+    x(0, 0) = -100.0;
+    x(1, 0) = 100.0;
+    const auto y = sigmoid<SigmoidMode::Exact>(x);
+    for (int i = 0; i < x.size(); ++i) {
+        const Scalar expected = sigmoid(x(i));
+        EXPECT_NEAR(y(i), expected, 4 * ulp * expected) << x(i);
+    }
+}
+
+TEST(MathUtils, SigmoidArray_Fast_WithinDocumentedError) {
+    constexpr int kSamples = 20001;
+    Eigen::Array<Scalar, Eigen::Dynamic, 1> x =
+        Eigen::Array<Scalar, Eigen::Dynamic, 1>::LinSpaced(kSamples, -12.0, 12.0);
+    const auto y = sigmoid<SigmoidMode::Fast>(x);
+    for (int i = 0; i < kSamples; ++i) {
+        EXPECT_NEAR(y(i), sigmoid(x(i)), SIGMOID_FAST_MAX_ERROR) << x(i);
+        EXPECT_EQ(y(i), sigmoid<SigmoidMode::Fast>(x(i))) << x(i);  // スカラー版と一致
+    }
+    EXPECT_EQ(sigmoid<SigmoidMode::Fast>(Scalar(0.0)), 0.5);
+    EXPECT_GE(y.minCoeff(), 0.0);
+    EXPECT_LE(y.maxCoeff(), 1.0);
+}
+
 // === Clamp テスト ===
 
 TEST(MathUtils, Clamp_BelowMin_ReturnsMin) {
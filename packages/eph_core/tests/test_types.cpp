@@ -24,8 +24,8 @@ TEST(Types, AgentState_ParameterizedConstructor_SetsValuesCorrectly) {
     EXPECT_DOUBLE_EQ(state.position.y(), 2.0);
     EXPECT_DOUBLE_EQ(state.velocity.x(), 3.0);
     EXPECT_DOUBLE_EQ(state.velocity.y(), 4.0);
-    EXPECT_DOUBLE_EQ(state.kappa, 0.5);
-    EXPECT_DOUBLE_EQ(state.fatigue, 0.7);
+    EXPECT_DOUBLE_EQ(state.kappa, Scalar(0.5));
+    EXPECT_DOUBLE_EQ(state.fatigue, Scalar(0.7));
 }
 
 // ChannelIDのテスト
@@ -43,14 +43,21 @@ TEST(Types, ChannelID_EnumValues_MatchSpecification) {
 }
 
 // Scalar型のテスト
+// 単精度構成（EPH_SINGLE_PRECISION）では float
+#if defined(EPH_SINGLE_PRECISION) && !defined(EPH_FORCE_DOUBLE_PRECISION)
+TEST(Types, Scalar_IsFloat) {
+    EXPECT_TRUE((std::is_same<Scalar, float>::value));
+}
+#else
 TEST(Types, Scalar_IsDouble) {
     EXPECT_TRUE((std::is_same<Scalar, double>::value));
 }
+#endif
 
 // Vec2型のテスト
 TEST(Types, Vec2_IsEigenVector2d) {
     Vec2 v(1.0, 2.0);
     EXPECT_DOUBLE_EQ(v.x(), 1.0);
     EXPECT_DOUBLE_EQ(v.y(), 2.0);
-    EXPECT_DOUBLE_EQ(v.norm(), std::sqrt(5.0));
+    EXPECT_DOUBLE_EQ(v.norm(), std::sqrt(Scalar(5.0)));
 }
@@ -10,6 +10,7 @@
 #include <iomanip>
 #include <Eigen/Core>
 #include "eph_core/types.hpp"
+#include "eph_spm/polar_grid.hpp"
 
 namespace eph::phase {
 
@@ -42,7 +43,8 @@ public:
      * φ = (1/N) Σᵢ |h_i - h̄|
      *
      * 各エージェントのhaze空間平均h_iと、全エージェントの平均h̄との
-     * 偏差の絶対値の平均を計算します。
+     * 偏差の絶対値の平均を計算します。h_i は視野内ビンの平均です
+     * （spm::visible_mean、死角ビンは知覚されないため含めません）。
      *
      * @param haze_fields 全エージェントのhazeフィールド（N×12×12）
      * @return 秩序パラメータφ [0, 1]
@@ -54,10 +56,10 @@ public:
 
         size_t N = haze_fields.size();
 
-        // 1. 各hazeフィールドの空間平均h_iを計算
+        // 1. 各hazeフィールドの空間平均h_iを計算（視野内ビンのみ）
         std::vector<Scalar> h_means(N);
         for (size_t i = 0; i < N; ++i) {
-            h_means[i] = haze_fields[i].mean();
+            h_means[i] = spm::visible_mean(haze_fields[i]);
         }
 
         // 2. 全エージェントの平均h̄を計算
@@ -0,0 +1,356 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "eph_core/types.hpp"
+#include "eph_core/constants.hpp"
+#include "eph_spm/saliency_polar_map.hpp"
+#include "eph_agent/eph_agent.hpp"
+#include "eph_swarm/swarm_manager.hpp"
+#include "eph_phase/phase_analyzer.hpp"
+
+using namespace eph;
+using namespace eph::agent;
+using namespace eph::spm;
+using namespace eph::swarm;
+using namespace eph::phase;
+
+/**
+ * @brief 精度ドリフト検証: V1–V5シナリオの再生
+ *
+ * 同一ソースを倍精度（EPH_FORCE_DOUBLE_PRECISION）と単精度（EPH_SINGLE_PRECISION）で
+ * ビルドし、V1–V5検証シナリオの代表量を比較する。
+ *
+ * ## 使い方
+ * - 参照値の書き出し（倍精度ビルド）:
+ *     precision_replay_f64 --write reference.csv
+ * - ドリフト報告（単精度ビルド）:
+ *     precision_replay_f32 --reference reference.csv [--max-drift 0.05]
+ *         [--tolerance 'v2.*.chi=1e-12' ...]
+ *
+ * 許容誤差（絶対ドリフト）はメトリクスごとに --tolerance PATTERN=X で与える。PATTERN は
+ * メトリクス名（'*' は任意の文字列）で、複数一致したときは後に指定したものが優先。
+ * --max-drift X は --tolerance '*=X' と同じ。許容誤差のないメトリクスは報告のみ。
+ *
+ * 乱数入力はすべて倍精度で生成してからScalarへ変換し、両ビルドで入力を一致させる。
+ * 非有限値（NaN/Inf）・欠損メトリクス・許容誤差超過で終了コード1を返す。
+ */
+
+namespace {
+
+using Metrics = std::vector<std::pair<std::string, double>>;
+using Tolerances = std::vector<std::pair<std::string, double>>;  // (PATTERN, 絶対ドリフト上限)
+
+constexpr const char* precision_name() {
+    return std::is_same_v<Scalar, float> ? "float32" : "float64";
+}
+
+// 倍精度で生成したランダムSaliency（両ビルドで同一入力）
+SaliencyPolarMap make_random_spm(int seed) {
+    SaliencyPolarMap spm;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(0.2, 0.8);
+    Matrix12x12 saliency;
+    for (int a = 0; a < constants::N_THETA; ++a) {
+        for (int b = 0; b < constants::N_R; ++b) {
+            saliency(a, b) = static_cast<Scalar>(dist(rng));
+        }
+    }
+    spm.set_channel(ChannelID::F2, saliency);
+    return spm;
+}
+
+void randomize_haze(SwarmManager& swarm, int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(0.2, 0.8);
+    for (size_t i = 0; i < swarm.size(); ++i) {
+        swarm.get_agent(i).set_effective_haze(
+            Matrix12x12::Constant(static_cast<Scalar>(dist(rng))));
+    }
+}
+
+struct SwarmSummary {
+    double phi = 0.0;
+    double avg_haze = 0.0;
+    double avg_speed = 0.0;
+    double avg_fatigue = 0.0;
+};
+
+SwarmSummary summarize(const SwarmManager& swarm) {
+    SwarmSummary s;
+    auto fields = swarm.get_all_haze_fields();
+    s.phi = PhaseAnalyzer::compute_phi(fields);
+    for (size_t i = 0; i < swarm.size(); ++i) {
+        const auto& agent = swarm.get_agent(i);
+        s.avg_haze += visible_mean(agent.haze());
+        s.avg_speed += agent.state().velocity.norm();
+        s.avg_fatigue += agent.state().fatigue;
+    }
+    const double n = static_cast<double>(swarm.size());
+    s.avg_haze /= n;
+    s.avg_speed /= n;
+    s.avg_fatigue /= n;
+    return s;
+}
+
+// V1: 予測誤差フィードバックループ（単一エージェント長時間）
+void replay_v1(Metrics& out) {
+    AgentState initial_state(Vec2(0.0, 0.0), Vec2(0.5, 0.5), 1.0, 0.0);
+    EPHAgent agent(initial_state, 1.0);
+    auto spm = make_random_spm(42);
+
+    for (int t = 0; t < 500; ++t) {
+        agent.update(spm, 0.1);
+    }
+    out.emplace_back("v1.speed", agent.state().velocity.norm());
+    out.emplace_back("v1.haze_mean", visible_mean(agent.haze()));
+    out.emplace_back("v1.fatigue", agent.state().fatigue);
+}
+
+// V3: ボトムアップ顕著性（θ方向のcos勾配）
+void replay_v3(Metrics& out) {
+    AgentState initial_state(Vec2(0.0, 0.0), Vec2(0.5, 0.0), 1.0, 0.0);
+    EPHAgent agent(initial_state, 1.0);
+
+    SaliencyPolarMap spm;
+    Matrix12x12 field;
+    for (int a = 0; a < constants::N_THETA; ++a) {
+        for (int b = 0; b < constants::N_R; ++b) {
+            const double theta = a * (2.0 * constants::PI / constants::N_THETA);
+            field(a, b) = static_cast<Scalar>(0.5 + 0.5 * std::cos(theta));
+        }
+    }
+    spm.set_channel(ChannelID::F2, field);
+    agent.set_effective_haze(Matrix12x12::Constant(0.5));
+
+    for (int t = 0; t < 100; ++t) {
+        agent.update(spm, 0.1);
+    }
+    out.emplace_back("v3.vx", agent.state().velocity.x());
+    out.emplace_back("v3.vy", agent.state().velocity.y());
+    out.emplace_back("v3.haze_mean", visible_mean(agent.haze()));
+}
+
+// V2: β掃引（相転移検出、軽量版）
+void replay_v2(Metrics& out) {
+    const std::vector<double> betas = {0.0, 0.05, 0.098, 0.15, 0.3};
+    auto spm = make_random_spm(42);
+
+    for (double beta : betas) {
+        SwarmManager swarm(50, static_cast<Scalar>(beta), 6);
+        randomize_haze(swarm, 123);
+        for (int t = 0; t < 100; ++t) {
+            swarm.update_all_agents(spm, 0.1);
+        }
+
+        std::vector<Scalar> phi_samples;
+        for (int t = 0; t < 30; ++t) {
+            swarm.update_all_agents(spm, 0.1);
+            phi_samples.push_back(PhaseAnalyzer::compute_phi(swarm.get_all_haze_fields()));
+        }
+
+        std::ostringstream key;
+        key << std::fixed << std::setprecision(3) << "v2.beta=" << beta;
+        out.emplace_back(key.str() + ".phi", PhaseAnalyzer::mean(phi_samples));
+        out.emplace_back(key.str() + ".chi", PhaseAnalyzer::compute_chi(phi_samples));
+    }
+}
+
+// V4: 長時間数値安定性
+void replay_v4(Metrics& out) {
+    SwarmManager swarm(20, static_cast<Scalar>(constants::BETA_C_TYPICAL), 6);
+    randomize_haze(swarm, 123);
+    auto spm = make_random_spm(42);
+
+    for (int t = 0; t < 2000; ++t) {
+        swarm.update_all_agents(spm, 0.1);
+    }
+    auto s = summarize(swarm);
+    out.emplace_back("v4.phi", s.phi);
+    out.emplace_back("v4.avg_haze", s.avg_haze);
+    out.emplace_back("v4.avg_speed", s.avg_speed);
+    out.emplace_back("v4.avg_fatigue", s.avg_fatigue);
+}
+
+// V5: 大規模群（N=100）
+void replay_v5(Metrics& out) {
+    SwarmManager swarm(100, static_cast<Scalar>(constants::BETA_C_TYPICAL), 6);
+    randomize_haze(swarm, 123);
+    auto spm = make_random_spm(42);
+
+    for (int t = 0; t < 200; ++t) {
+        swarm.update_all_agents(spm, 0.1);
+    }
+    auto s = summarize(swarm);
+    out.emplace_back("v5.phi", s.phi);
+    out.emplace_back("v5.avg_haze", s.avg_haze);
+    out.emplace_back("v5.avg_speed", s.avg_speed);
+    out.emplace_back("v5.avg_fatigue", s.avg_fatigue);
+}
+
+auto run_all() -> Metrics {
+    Metrics m;
+    replay_v1(m);
+    replay_v2(m);
+    replay_v3(m);
+    replay_v4(m);
+    replay_v5(m);
+    return m;
+}
+
+auto read_reference(const std::string& path, std::map<std::string, double>& ref) -> bool {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "Error: Could not open reference file " << path << "\n";
+        return false;
+    }
+    std::string line;
+    std::getline(in, line);  // ヘッダー
+    while (std::getline(in, line)) {
+        auto comma = line.find(',');
+        if (comma == std::string::npos) continue;
+        ref[line.substr(0, comma)] = std::stod(line.substr(comma + 1));
+    }
+    return true;
+}
+
+// '*' を任意の文字列（空を含む）として name が pattern に一致するか
+auto glob_match(const char* pattern, const char* name) -> bool {
+    if (*pattern == '\0') return *name == '\0';
+    if (*pattern == '*') {
+        return glob_match(pattern + 1, name) || (*name != '\0' && glob_match(pattern, name + 1));
+    }
+    return *name == *pattern && glob_match(pattern + 1, name + 1);
+}
+
+// メトリクスの許容誤差（後に指定したものが優先、一致なしは負値）
+auto tolerance_for(const Tolerances& tolerances, const std::string& name) -> double {
+    double tol = -1.0;
+    for (const auto& [pattern, value] : tolerances) {
+        if (glob_match(pattern.c_str(), name.c_str())) {
+            tol = value;
+        }
+    }
+    return tol;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string write_path;
+    std::string reference_path;
+    Tolerances tolerances;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--write") == 0 && i + 1 < argc) {
+            write_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--reference") == 0 && i + 1 < argc) {
+            reference_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--max-drift") == 0 && i + 1 < argc) {
+            tolerances.emplace_back("*", std::atof(argv[++i]));
+        } else if (std::strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            const std::string spec = argv[++i];
+            const auto eq = spec.rfind('=');
+            if (eq == std::string::npos || eq == 0) {
+                std::cerr << "Invalid tolerance (expected PATTERN=X): " << spec << "\n";
+                return 2;
+            }
+            tolerances.emplace_back(spec.substr(0, eq), std::atof(spec.c_str() + eq + 1));
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--write out.csv] [--reference ref.csv [--max-drift X] [--tolerance PATTERN=X]...]\n";
+            return 2;
+        }
+    }
+
+    std::cout << "[Precision] Replaying V1-V5 scenarios (" << precision_name() << ")\n";
+    const Metrics metrics = run_all();
+
+    bool ok = true;
+    for (const auto& [name, value] : metrics) {
+        if (!std::isfinite(value)) {
+            std::cerr << "Non-finite result: " << name << " = " << value << "\n";
+            ok = false;
+        }
+    }
+
+    if (!write_path.empty()) {
+        std::ofstream file(write_path);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open file " << write_path << " for writing\n";
+            return 1;
+        }
+        file << "metric,value\n";
+        file << std::setprecision(17);
+        for (const auto& [name, value] : metrics) {
+            file << name << "," << value << "\n";
+        }
+        std::cout << "Reference written: " << write_path << " (" << metrics.size() << " metrics)\n";
+    }
+
+    if (!reference_path.empty()) {
+        std::map<std::string, double> ref;
+        if (!read_reference(reference_path, ref)) {
+            return 1;
+        }
+
+        double worst_abs = 0.0;
+        std::string worst_name;
+        int exceeded = 0;
+        std::cout << std::left << std::setw(24) << "metric"
+                  << std::right << std::setw(14) << "reference"
+                  << std::setw(14) << precision_name()
+                  << std::setw(12) << "abs drift"
+                  << std::setw(12) << "rel drift"
+                  << std::setw(12) << "tolerance" << "\n";
+        std::cout << std::scientific << std::setprecision(3);
+        for (const auto& [name, value] : metrics) {
+            auto it = ref.find(name);
+            if (it == ref.end()) {
+                std::cerr << "Missing reference metric: " << name << "\n";
+                ok = false;
+                continue;
+            }
+            const double abs_drift = std::abs(value - it->second);
+            const double rel_drift = abs_drift / std::max(std::abs(it->second), 1e-12);
+            const double tol = tolerance_for(tolerances, name);
+            const bool over = tol >= 0.0 && !(abs_drift <= tol);
+            std::cout << std::left << std::setw(24) << name
+                      << std::right << std::setw(14) << it->second
+                      << std::setw(14) << value
+                      << std::setw(12) << abs_drift
+                      << std::setw(12) << rel_drift;
+            if (tol >= 0.0) {
+                std::cout << std::setw(12) << tol;
+            } else {
+                std::cout << std::setw(12) << "-";
+            }
+            std::cout << (over ? "  EXCEEDED" : "") << "\n";
+            if (over) {
+                ++exceeded;
+            }
+            if (abs_drift > worst_abs) {
+                worst_abs = abs_drift;
+                worst_name = name;
+            }
+        }
+        std::cout << "[Precision] Max abs drift: " << worst_abs
+                  << " (" << (worst_name.empty() ? "-" : worst_name) << ")\n";
+
+        if (exceeded > 0) {
+            std::cerr << exceeded << " metric(s) exceed tolerance\n";
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
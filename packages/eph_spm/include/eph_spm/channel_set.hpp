@@ -0,0 +1,73 @@
+#ifndef EPH_SPM_CHANNEL_SET_HPP
+#define EPH_SPM_CHANNEL_SET_HPP
+
+#include <cstdint>
+#include "eph_core/types.hpp"
+#include "eph_core/constants.hpp"
+
+namespace eph::spm {
+
+/**
+ * @brief SPMチャネル集合（ChannelID のビットマスク、コンパイル時に宣言）
+ *
+ * 消費側（ActionSelector / HazeEstimator / EPHAgent）は読むチャネルを
+ * kReadChannels として宣言し、生成側（SpmRasterizer / LazySpm）は
+ * 要求されたチャネルだけを計算する。
+ *
+ * ```cpp
+ * constexpr ChannelMask kRead = kChannelMask<ChannelID::F2, ChannelID::F5>;
+ * static_assert(contains(with_dependencies(kRead), ChannelID::F0));
+ * ```
+ */
+using ChannelMask = std::uint32_t;
+
+static_assert(constants::N_CHANNELS <= 32, "ChannelMask holds at most 32 channels");
+
+constexpr auto channel_bit(ChannelID id) -> ChannelMask {
+    return ChannelMask(1) << static_cast<int>(id);
+}
+
+template <ChannelID... Ids>
+inline constexpr ChannelMask kChannelMask = (ChannelMask(0) | ... | channel_bit(Ids));
+
+inline constexpr ChannelMask kNoChannels = 0;
+inline constexpr ChannelMask kAllChannels = (ChannelMask(1) << constants::N_CHANNELS) - 1;
+
+constexpr auto contains(ChannelMask mask, ChannelID id) -> bool {
+    return (mask & channel_bit(id)) != 0;
+}
+
+/**
+ * @brief チャネルが直接依存するチャネル
+ *
+ * 時間チャネル R0（Δ占有）と F5（観測安定性）は占有 F0 から導出する
+ * （temporal_channels.hpp）。その他は近傍から直接生成する。
+ */
+constexpr auto channel_dependencies(ChannelID id) -> ChannelMask {
+    switch (id) {
+        case ChannelID::R0:
+        case ChannelID::F5:
+            return channel_bit(ChannelID::F0);
+        default:
+            return kNoChannels;
+    }
+}
+
+// 依存の推移閉包（要求集合 + 計算に必要なチャネル）
+constexpr auto with_dependencies(ChannelMask mask) -> ChannelMask {
+    ChannelMask closed = mask;
+    ChannelMask previous = kNoChannels;
+    while (closed != previous) {
+        previous = closed;
+        for (int c = 0; c < constants::N_CHANNELS; ++c) {
+            if (closed & (ChannelMask(1) << c)) {
+                closed |= channel_dependencies(static_cast<ChannelID>(c));
+            }
+        }
+    }
+    return closed;
+}
+
+}  // namespace eph::spm
+
+#endif  // EPH_SPM_CHANNEL_SET_HPP
@@ -0,0 +1,142 @@
+#ifndef EPH_SPM_GRADIENT_KERNEL_HPP
+#define EPH_SPM_GRADIENT_KERNEL_HPP
+
+#include <Eigen/Core>
+#include "eph_core/types.hpp"
+#include "eph_core/constants.hpp"
+#include "eph_spm/polar_grid.hpp"
+#include "eph_spm/stencil.hpp"
+
+namespace eph::spm::kernel {
+
+/**
+ * @brief 融合勾配カーネル（θ勾配・r勾配・勾配の大きさを1パスで計算）
+ *
+ * 列優先の θ×r チャネルを r 列ごとに1回だけ走査し、各列を θ 方向の
+ * Eigen パケット（SIMD）で処理する。中間テンソルは作らない。
+ * ステンシルエンジン（stencil::PolarDerivative）の列演算として書かれ、
+ * r 列ループは完全展開される。
+ *
+ * 境界条件:
+ * - θ方向: 周期境界（折り返す端行のみテーブル参照、内部はシフト差分）
+ * - r方向: Neumann境界（端セルで鏡映 → b=0, b=N_R-1 でゼロ勾配）
+ *
+ * 視野マスク（FovMask）: 各列の視野内行 [0, kVisible) のみ計算し、死角行の出力は0。
+ * 視野端の行（0 と kVisible-1）は周期近傍として死角行の入力値を読む。
+ *
+ * r 勾配の単位は標準格子の r ビン1個あたり。ピラミッドの粗い段（r ビン幅 2^L）では
+ * r_bin_width を渡して段間で勾配の大きさを比較可能にする。
+ *
+ * @tparam kWriteComponents true のとき θ/r 勾配も出力する
+ */
+namespace detail {
+
+// 1列分の処理。列 b はコンパイル時定数なので境界分岐は消える
+template <bool kWriteComponents, typename Col, typename OutT, typename OutR, typename OutM>
+EIGEN_STRONG_INLINE void fused_gradient_column(
+    const Col& col,
+    OutT* grad_theta,
+    OutR* grad_r,
+    Eigen::MatrixBase<OutM>& magnitude,
+    typename Col::Scalar two_dtheta,
+    typename Col::Scalar half_inv_dr
+) {
+    constexpr int b = Col::kColumn;
+    constexpr int NT = Col::kNTheta;
+    constexpr int NV = Col::Values::RowsAtCompileTime;  // 計算する行数
+    using Column = typename Col::Values;
+
+    // θ方向: 中心差分（周期境界）
+    const Column gt = (col.template at<1, 0>() - col.template at<-1, 0>()) / two_dtheta;
+
+    if constexpr (Col::template kSymmetricR<1>) {
+        // r方向: Neumann境界（ゼロ勾配）→ |∇| = |∂θ|
+        magnitude.col(b).template head<NV>() = gt.abs().matrix();
+        if constexpr (kWriteComponents) {
+            grad_r->col(b).setZero();
+        }
+    } else {
+        const Column gr = (col.template at<0, 1>() - col.template at<0, -1>()) * half_inv_dr;
+        magnitude.col(b).template head<NV>() = (gt.square() + gr.square()).sqrt().matrix();
+        if constexpr (kWriteComponents) {
+            grad_r->col(b).template head<NV>() = gr.matrix();
+        }
+    }
+
+    if constexpr (kWriteComponents) {
+        grad_theta->col(b).template head<NV>() = gt.matrix();
+    }
+
+    // 死角行は0
+    if constexpr (NV < NT) {
+        magnitude.col(b).template tail<NT - NV>().setZero();
+        if constexpr (kWriteComponents) {
+            grad_theta->col(b).template tail<NT - NV>().setZero();
+            grad_r->col(b).template tail<NT - NV>().setZero();
+        }
+    }
+}
+
+template <bool kWriteComponents, typename InDerived, typename OutT, typename OutR, typename OutM>
+inline void fused_gradient_impl(
+    const Eigen::MatrixBase<InDerived>& ch,
+    OutT* grad_theta,
+    OutR* grad_r,
+    Eigen::MatrixBase<OutM>& magnitude,
+    int r_bin_width
+) {
+    using Scalar = typename InDerived::Scalar;
+    constexpr int NT = InDerived::RowsAtCompileTime;
+    constexpr int NR = InDerived::ColsAtCompileTime;
+    static_assert(NT >= 3 && NR >= 1, "Polar grid must have fixed size with at least 3 θ bins");
+    using Mask = FovMask<NT>;
+    constexpr int NV = Mask::kFull ? NT : Mask::kVisible;
+
+    // 2Δθ, Δθ = 2π / N_θ（従来の演算子とビット一致させるため除算で適用）
+    const Scalar two_dtheta = static_cast<Scalar>(2.0 * (2.0 * constants::PI / NT));
+    // 1 / (2Δr)（Δr = r_bin_width は2の冪なので標準格子では従来の 0.5 と一致）
+    const Scalar half_inv_dr = Scalar(0.5) / static_cast<Scalar>(r_bin_width);
+
+    stencil::PolarDerivative::for_each_column<NV>(ch, [&](const auto& col) {
+        fused_gradient_column<kWriteComponents>(col, grad_theta, grad_r, magnitude, two_dtheta, half_inv_dr);
+    });
+}
+
+}  // namespace detail
+
+/**
+ * @brief θ勾配・r勾配・大きさを1パスで計算
+ *
+ * @param ch 入力チャネル（θ×r）
+ * @param grad_theta θ方向勾配（出力）
+ * @param grad_r r方向勾配（出力）
+ * @param magnitude 勾配の大きさ（出力）
+ * @param r_bin_width r ビン幅（標準格子のビン数、ピラミッド段 L では 2^L）
+ */
+template <typename InDerived, typename OutT, typename OutR, typename OutM>
+inline void fused_gradient(
+    const Eigen::MatrixBase<InDerived>& ch,
+    Eigen::MatrixBase<OutT>& grad_theta,
+    Eigen::MatrixBase<OutR>& grad_r,
+    Eigen::MatrixBase<OutM>& magnitude,
+    int r_bin_width = 1
+) {
+    detail::fused_gradient_impl<true>(ch, &grad_theta, &grad_r, magnitude, r_bin_width);
+}
+
+/**
+ * @brief 勾配の大きさのみを1パスで計算（行為選択のホットパス用）
+ */
+template <typename InDerived, typename OutM>
+inline void gradient_magnitude(
+    const Eigen::MatrixBase<InDerived>& ch,
+    Eigen::MatrixBase<OutM>& magnitude,
+    int r_bin_width = 1
+) {
+    using Dummy = Eigen::MatrixBase<OutM>;
+    detail::fused_gradient_impl<false, InDerived, Dummy, Dummy>(ch, nullptr, nullptr, magnitude, r_bin_width);
+}
+
+}  // namespace eph::spm::kernel
+
+#endif  // EPH_SPM_GRADIENT_KERNEL_HPP
@@ -0,0 +1,149 @@
+#ifndef EPH_SPM_LAZY_SPM_HPP
+#define EPH_SPM_LAZY_SPM_HPP
+
+#include <cassert>
+#include <optional>
+#include <utility>
+#include "eph_core/types.hpp"
+#include "eph_spm/channel_set.hpp"
+#include "eph_spm/saliency_polar_map.hpp"
+
+namespace eph::spm {
+
+/**
+ * @brief 要求チャネルを初回アクセス時に生成するSPM
+ *
+ * 消費側が宣言したチャネル集合 Requested（例: EPHAgent::kReadChannels）のみを、
+ * フレーム内で最初に読まれたときに生成関数で計算する。読まれなかったチャネルは
+ * 計算しないため、高価なチャネル（TTC・可視性など）を追加しても、それを読まない
+ * 構成の速度は変わらない。ActionSelector / HazeEstimator / EPHAgent::update は
+ * SaliencyPolarMap と同じくこの型を受け取れる。
+ *
+ * ## 生成関数
+ * producer(id, map) はチャネル id を map に書き込む（set_channel / fill_channel /
+ * mutable_channel）。依存チャネル（channel_dependencies）は先に生成される。
+ * 時間チャネル R0・F5 は生成関数を呼ばず、F0 の生成後に map.update_temporal() で
+ * 導出する（F0 を生成するたびに占有の表裏を入れ替えるため、前フレーム占有は
+ * 「前回 F0 を生成したフレーム」の値になる）。
+ *
+ * 読み出しは const だが、生成（と派生量の確定）は論理的に const な遅延評価として扱う。
+ * 同一インスタンスを複数スレッドから同時に読まないこと。
+ *
+ * @tparam Requested 生成を許すチャネル集合（依存の閉包は自動で含む）
+ * @tparam Producer void(ChannelID, MapT&) を呼べる型
+ * @tparam MapT 格納先のマップ型
+ */
+template <ChannelMask Requested, typename Producer, typename MapT = SaliencyPolarMap>
+class BasicLazySpm {
+public:
+    using Map = MapT;
+    using Scalar = typename Map::Scalar;
+    using ChannelMatrix = typename Map::ChannelMatrix;
+    using ConstChannelMap = typename Map::ConstChannelMap;
+    using GradientField = typename Map::GradientField;
+
+    static constexpr ChannelMask kRequested = Requested;
+    static constexpr ChannelMask kEvaluated = with_dependencies(Requested);
+
+    static_assert((kEvaluated >> Map::channel_count()) == 0, "Requested channel outside the map layout");
+
+    explicit BasicLazySpm(Producer producer)
+        : producer_(std::move(producer)) {}
+
+    /**
+     * @brief 新しいフレームを開始（全チャネルを未計算に戻す）
+     */
+    void begin_frame() {
+        evaluated_ = kNoChannels;
+    }
+
+    // チャネルアクセス（初回アクセス時に生成）
+    auto channel(eph::ChannelID id) const -> ConstChannelMap {
+        ensure(id);
+        return map_.channel(id);
+    }
+
+    auto get_channel(eph::ChannelID id) const -> ChannelMatrix {
+        ensure(id);
+        return map_.get_channel(id);
+    }
+
+    auto uniform_value(eph::ChannelID id) const -> std::optional<Scalar> {
+        ensure(id);
+        return map_.uniform_value(id);
+    }
+
+    // 派生量（生成時にマップ側で確定した値を使う）
+    auto gradient_magnitude(eph::ChannelID id) const -> ChannelMatrix {
+        ensure(id);
+        return map_.gradient_magnitude(id);
+    }
+
+    auto gradient_magnitude_mean(eph::ChannelID id) const -> Scalar {
+        ensure(id);
+        return map_.gradient_magnitude_mean(id);
+    }
+
+    auto gradient_magnitude_mean(eph::ChannelID id, int level) const -> Scalar {
+        ensure(id);
+        return map_.gradient_magnitude_mean(id, level);
+    }
+
+    auto channel_mean(eph::ChannelID id) const -> Scalar {
+        ensure(id);
+        return map_.channel_mean(id);
+    }
+
+    auto gradient(eph::ChannelID id) const -> GradientField {
+        ensure(id);
+        return map_.gradient(id);
+    }
+
+    // 現フレームで計算済みのチャネル集合
+    auto evaluated() const -> ChannelMask { return evaluated_; }
+
+    // 格納先（未計算チャネルは前回の値のまま）
+    auto map() const -> const Map& { return map_; }
+
+private:
+    Producer producer_;
+    mutable Map map_;
+    mutable ChannelMask evaluated_ = kNoChannels;
+
+    void ensure(eph::ChannelID id) const {
+        assert(contains(kEvaluated, id) && "Channel was not declared in the requested set");
+        if (contains(evaluated_, id)) {
+            return;
+        }
+        if constexpr (Map::has_temporal_channels()) {
+            if (id == ChannelID::R0 || id == ChannelID::F5) {
+                ensure(ChannelID::F0);
+                map_.update_temporal();
+                map_.warm_cache(ChannelID::R0);
+                map_.warm_cache(ChannelID::F5);
+                evaluated_ |= kChannelMask<ChannelID::R0, ChannelID::F5>;
+                return;
+            }
+            if (id == ChannelID::F0) {
+                map_.begin_frame();
+            }
+        }
+        producer_(id, map_);
+        map_.warm_cache(id);
+        evaluated_ |= channel_bit(id);
+    }
+};
+
+// 標準構成（10ch, 12×12）
+template <ChannelMask Requested, typename Producer>
+using LazySpm = BasicLazySpm<Requested, Producer, SaliencyPolarMap>;
+
+// 生成関数の型を推論して LazySpm を作る
+template <ChannelMask Requested, typename Producer>
+auto make_lazy_spm(Producer producer) -> LazySpm<Requested, Producer> {
+    return LazySpm<Requested, Producer>(std::move(producer));
+}
+
+}  // namespace eph::spm
+
+#endif  // EPH_SPM_LAZY_SPM_HPP
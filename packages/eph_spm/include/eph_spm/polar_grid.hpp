@@ -0,0 +1,106 @@
+#ifndef EPH_SPM_POLAR_GRID_HPP
+#define EPH_SPM_POLAR_GRID_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include "eph_core/types.hpp"
+#include "eph_core/constants.hpp"
+
+namespace eph::spm {
+
+/**
+ * @brief 自己中心極座標格子のビン割り当て
+ *
+ * θビン a は進行方向基準の方位角 [-FOV/2 + a·Δθ, -FOV/2 + (a+1)·Δθ) を表す
+ * （constants.hpp の FOV 注記と同じ規約）。270° FOV では a ∈ [0, 8] が視野内、
+ * a ∈ [9, 11] が後方の死角となる。
+ *
+ * rビン b は [0, r_max) を N_R 等分した線形分割（appendix B §2.1）。
+ */
+
+/**
+ * @brief 視野マスク（コンパイル時、FIELD_OF_VIEW_DEGREES から導出）
+ *
+ * 上記の規約では視野内ビンは先頭の連続区間 [0, kVisible) になる。
+ * 列優先の θ×r チャネルでは各 r 列の先頭 kVisible 要素が視野内。
+ * 視野外ビン（死角）はエージェントが知覚しない方位なので、空間平均による観測量
+ * （チャネル・勾配の大きさの平均、Epistemic項の ⟨h⟩、秩序パラメータ φ、
+ * テレメトリのHaze平均）は visible_mean() で視野内ビンのみから定義する。
+ * 勾配・haze推定・ラスタライズも死角ビンを処理しない。ただし視野端の
+ * ステンシルは周期境界に従い死角ビンの値を近傍として読む。
+ *
+ * 360° FOV では kFull となり、全カーネルは従来の全ビン経路と同一になる。
+ */
+template <int NTheta = constants::N_THETA>
+struct FovMask {
+    static constexpr double kBinsInFov = constants::FIELD_OF_VIEW_DEGREES * NTheta / 360.0;
+    static constexpr int kVisible = static_cast<int>(kBinsInFov) < kBinsInFov
+        ? static_cast<int>(kBinsInFov) + 1
+        : static_cast<int>(kBinsInFov);
+    static constexpr bool kFull = kVisible >= NTheta;
+
+    static_assert(kVisible >= 2, "FOV must cover at least two θ bins");
+
+    static constexpr auto visible(int a) -> bool { return kFull || a < kVisible; }
+};
+
+/**
+ * @brief 視野内ビンのみの平均（θ×r フィールド）
+ *
+ * 視野外の行は読まない。360° FOV では field.mean() と同一。
+ */
+template <typename Derived>
+inline auto visible_mean(const Eigen::MatrixBase<Derived>& field) -> typename Derived::Scalar {
+    using Mask = FovMask<Derived::RowsAtCompileTime>;
+    if constexpr (Mask::kFull) {
+        return field.mean();
+    } else {
+        return field.template topRows<Mask::kVisible>().mean();
+    }
+}
+
+/**
+ * @brief 方位角 → θビン
+ * @param bearing 進行方向基準の方位角 [rad]（任意範囲、周期的に扱う）
+ * @return θビン index [0, NTheta)
+ */
+template <int NTheta = constants::N_THETA>
+inline int theta_bin(Scalar bearing) {
+    constexpr Scalar kTwoPi = static_cast<Scalar>(2.0 * constants::PI);
+    constexpr Scalar kDeltaTheta = static_cast<Scalar>(2.0 * constants::PI / NTheta);
+
+    Scalar shifted = std::fmod(bearing + constants::FIELD_OF_VIEW_RADIANS / Scalar(2.0), kTwoPi);
+    if (shifted < Scalar(0.0)) {
+        shifted += kTwoPi;
+    }
+    const int a = static_cast<int>(shifted / kDeltaTheta);
+    return std::min(a, NTheta - 1);  // 丸め誤差で 2π ちょうどになる場合
+}
+
+/**
+ * @brief θビン中心の方位角
+ * @param a θビン index
+ * @return 進行方向基準の方位角 [rad]
+ */
+template <int NTheta = constants::N_THETA>
+inline Scalar theta_bin_center(int a) {
+    constexpr Scalar kDeltaTheta = static_cast<Scalar>(2.0 * constants::PI / NTheta);
+    return -constants::FIELD_OF_VIEW_RADIANS / Scalar(2.0) + (static_cast<Scalar>(a) + Scalar(0.5)) * kDeltaTheta;
+}
+
+/**
+ * @brief 距離 → rビン（線形分割）
+ * @param distance 距離 [m]（0 ≤ distance）
+ * @param r_max 知覚半径 [m]
+ * @return rビン index [0, NR)（r_max 以上は最外ビン）
+ */
+template <int NR = constants::N_R>
+inline int r_bin(Scalar distance, Scalar r_max) {
+    const int b = static_cast<int>(distance / r_max * static_cast<Scalar>(NR));
+    return std::clamp(b, 0, NR - 1);
+}
+
+}  // namespace eph::spm
+
+#endif  // EPH_SPM_POLAR_GRID_HPP
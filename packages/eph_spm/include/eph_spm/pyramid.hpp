@@ -0,0 +1,96 @@
+#ifndef EPH_SPM_PYRAMID_HPP
+#define EPH_SPM_PYRAMID_HPP
+
+#include <Eigen/Core>
+#include "eph_core/types.hpp"
+#include "eph_spm/gradient_kernel.hpp"
+#include "eph_spm/polar_grid.hpp"
+
+namespace eph::spm::pyramid {
+
+/**
+ * @brief 多重解像度ピラミッドの段構成（コンパイル時）
+ *
+ * 段 L は θ, r とも 2^L 倍に粗視化した格子（標準構成: 12×12 / 6×6 / 3×3）。
+ * θ, r がともに偶数である限り段を重ね、最大 kMaxLevels 段とする。
+ * 粗い段の θ ビン幅は 2π / N_θ^(L)、r ビン幅は元のビン 2^L 個分。
+ */
+template <int NTheta, int NR>
+struct Levels {
+    static constexpr int kMaxLevels = 3;
+
+    static constexpr auto count() -> int {
+        int levels = 1;
+        int nt = NTheta;
+        int nr = NR;
+        while (levels < kMaxLevels && nt % 2 == 0 && nr % 2 == 0 && nt / 2 >= 3) {
+            nt /= 2;
+            nr /= 2;
+            ++levels;
+        }
+        return levels;
+    }
+
+    static constexpr int kCount = count();
+
+    // 段 L の次元（存在しない段は1×1のダミー）
+    template <int L>
+    static constexpr int kTheta = (L < kCount) ? (NTheta >> L) : 1;
+    template <int L>
+    static constexpr int kR = (L < kCount) ? (NR >> L) : 1;
+
+};
+
+/**
+ * @brief 2×2 平均プーリング（1段粗視化）
+ *
+ * 粗い格子の (a, b) は細かい格子の (2a..2a+1, 2b..2b+1) の平均。
+ * r 方向の2列を先に足し、θ 方向は偶数行・奇数行のストライドビューで
+ * ベクトル演算する（列優先のまま、中間テンソルは1列分のみ）。
+ *
+ * @param fine 細かい格子（θ×r）
+ * @param coarse 粗い格子（出力、θ/2 × r/2）
+ */
+template <typename FineDerived, typename CoarseDerived>
+inline void downsample(
+    const Eigen::MatrixBase<FineDerived>& fine,
+    Eigen::MatrixBase<CoarseDerived>& coarse
+) {
+    using Scalar = typename FineDerived::Scalar;
+    constexpr int NT = FineDerived::RowsAtCompileTime;
+    constexpr int NT2 = CoarseDerived::RowsAtCompileTime;
+    constexpr int NR2 = CoarseDerived::ColsAtCompileTime;
+    static_assert(NT == 2 * NT2 && FineDerived::ColsAtCompileTime == 2 * NR2,
+                  "Coarse level must halve both dimensions");
+
+    using Column = Eigen::Array<Scalar, NT, 1>;
+    using Half = Eigen::Array<Scalar, NT2, 1>;
+    using Strided = Eigen::Map<const Half, Eigen::Unaligned, Eigen::InnerStride<2>>;
+
+    for (int b = 0; b < NR2; ++b) {
+        const Column pair = fine.col(2 * b).array() + fine.col(2 * b + 1).array();
+        coarse.col(b) = (Scalar(0.25) * (Strided(pair.data()) + Strided(pair.data() + 1))).matrix();
+    }
+}
+
+/**
+ * @brief 段 L のフィールドに対する ⟨|∇|⟩（視野内平均）
+ *
+ * r 勾配は標準格子の r ビン単位に揃える（段間で比較可能）。
+ *
+ * @param level_field 段 L のフィールド（θ×r）
+ * @param level 段番号 L
+ */
+template <typename Derived>
+inline auto gradient_magnitude_mean(const Eigen::MatrixBase<Derived>& level_field, int level)
+    -> typename Derived::Scalar {
+    using Field = Eigen::Matrix<typename Derived::Scalar,
+                                Derived::RowsAtCompileTime, Derived::ColsAtCompileTime>;
+    Field magnitude;
+    kernel::gradient_magnitude(level_field, magnitude, 1 << level);
+    return visible_mean(magnitude);
+}
+
+}  // namespace eph::spm::pyramid
+
+#endif  // EPH_SPM_PYRAMID_HPP
@@ -2,139 +2,469 @@
 #define EPH_SPM_SALIENCY_POLAR_MAP_HPP
 
 #include <Eigen/Core>
-#include <unsupported/Eigen/CXX11/Tensor>
+#include <array>
+#include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
 #include "eph_core/types.hpp"
 #include "eph_core/constants.hpp"
 #include "eph_core/math_utils.hpp"
+#include "eph_spm/gradient_kernel.hpp"
+#include "eph_spm/polar_grid.hpp"
+#include "eph_spm/pyramid.hpp"
+#include "eph_spm/stencil.hpp"
+#include "eph_spm/temporal_channels.hpp"
 
 namespace eph::spm {
 
 /**
  * @brief Saliency Polar Map with configurable field of view
  *
- * θ index interpretation (when FIELD_OF_VIEW_DEGREES = 270):
- *   - θ_idx = 0   → -135° (left edge of FOV)
- *   - θ_idx = 6   → 0° (forward, agent heading)
- *   - θ_idx = 11  → +135° (right edge of FOV)
+ * θ index interpretation (Δθ = 360° / N_THETA, see eph_spm/polar_grid.hpp):
+ *   - θ_idx = a covers [-FOV/2 + a·Δθ, -FOV/2 + (a+1)·Δθ) relative to heading
+ *   - FOV = 270°: θ_idx 0..8 cover [-135°, +135°] (θ_idx 4 is forward),
+ *     θ_idx 9..11 are the rear blind spot
  *
- * For 360° FOV: θ ∈ [0°, 360°)
- * For 270° FOV: θ ∈ [-135°, +135°] centered on heading
+ * ## 視野マスク
+ * 死角ビンは FovMask（コンパイル時）で除外し、融合勾配・勾配の大きさ・平均は
+ * 視野内ビンのみを処理する（死角の勾配出力は0）。gradient_theta() / gradient_r() は
+ * 境界条件検証用の参照演算子として全ビンを計算する。
+ *
+ * ## 次元（コンパイル時）
+ * チャネル数・θビン数・rビン数・スカラー型をテンプレート引数で固定する。
+ * 標準構成（10ch, 12×12）は SaliencyPolarMap エイリアスを使用。
+ * 高解像度（例: 24×16）や粗視化（例: 6×6）マップも同じ実装で扱え、
+ * ストレージは固定長（ヒープ確保なし）、ステンシルは完全展開される。
+ *
+ * ## メモリレイアウト
+ * 論理インデックスは (C, θ, r) だが、実体は (θ·r, C) の列優先固定長行列として保持する。
+ * これにより各チャネルは θ×r の列優先行列（ChannelMatrix と同一レイアウト）として
+ * 連続領域に並び、channel() / mutable_channel() がコピーなしの Eigen::Map を返せる。
+ *
+ * ## 派生量
+ * チャネルごとに版番号を持ち、set_channel() / mutable_channel() / zero_all() で進める。
+ * チャネル平均と各段の ⟨|∇|⟩ はスカラーのみ書き込み時に確定して版番号とともに保持し、
+ * 同じステップ内の繰り返し読み出し（全エージェントが共有マップを参照する場合など）は
+ * 再計算しない。mutable_channel() / begin_frame() / update_temporal() は書き込み内容が
+ * 分からないため、warm_cache() で確定するまでは読み出しのたびに計算する。
+ * 勾配の大きさ・ピラミッド段のフィールドは保持せず、読み出し時に計算する。
+ *
+ * const メソッドは状態を変更しないため、同一マップを複数スレッドから同時に読める。
+ *
+ * ## 一様チャネル
+ * 全ビンが同一の有限値であるチャネル（未使用のゼロチャネル、定数チャネル）を
+ * フラグで追跡する。zero_all() / fill_channel() で設定され、set_channel() は書き込み時に
+ * 一様性を判定する。mutable_channel() と update_temporal() は書き込み内容が分からないため
+ * フラグを落とす。一様チャネルの勾配は0、平均はその値として、ビンを走査せずに返す。
+ * フラグは格納列ごとに持つため、begin_frame() の表裏入れ替えにもそのまま追従する。
+ *
+ * ## 多重解像度ピラミッド
+ * 各チャネルを 2×2 平均プーリングで粗視化した段（標準構成: 12×12 / 6×6 / 3×3、
+ * pyramid::Levels）を pyramid_level<L>() で読める（段 L+1 は段 L から作る）。
+ * gradient_magnitude_mean(id, level) は段 level での ⟨|∇|⟩ で、上記の派生量として
+ * 段ごとに保持する。
+ * 重要度の低いエージェントは粗い段を選ぶことで Epistemic 項の計算量を 1/4・1/16 にできる。
+ *
+ * ## 時間チャネル（R0, F5）
+ * 占有 F0 は表裏2面のバッファを持つ（temporal::Layout）。1フレームの手順:
+ * 1. begin_frame(): 表裏を入れ替える（番号反転のみ、コピーなし）。前フレームの占有は
+ *    previous_occupancy() から読め、F0 には2フレーム前の値が残る
+ * 2. F0 を新しいフレームの占有で上書きする
+ * 3. update_temporal(): 現/前フレームから R0（Δ占有）と F5（観測安定性）を増分更新
+ *
+ * F5 を持たない縮小構成（Channels ≤ F5）では追加バッファを持たない。
+ *
+ * @tparam Channels チャネル数
+ * @tparam NTheta θ方向ビン数（周期境界）
+ * @tparam NR r方向ビン数（Neumann境界）
+ * @tparam ScalarT スカラー型
  */
-class SaliencyPolarMap {
+template <int Channels, int NTheta, int NR, typename ScalarT = eph::Scalar>
+class BasicSaliencyPolarMap {
+    static_assert(Channels > 0, "SPM needs at least one channel");
+    static_assert(NTheta >= 3, "Periodic θ stencil needs at least 3 bins");
+    static_assert(NR >= 1, "SPM needs at least one r bin");
+
 public:
-    using Scalar = eph::Scalar;
-    using Tensor3 = eph::Tensor3;
-    using Matrix12x12 = eph::Matrix12x12;
+    using Scalar = ScalarT;
+
+    static constexpr int kChannels = Channels;
+    static constexpr int kNTheta = NTheta;
+    static constexpr int kNR = NR;
+    static constexpr int kChannelSize = NTheta * NR;
+
+    // 1チャネル分のフィールド（θ×r、列優先）
+    using ChannelMatrix = Eigen::Matrix<Scalar, NTheta, NR>;
+
+    // 時間チャネル用の追加列配置
+    using Temporal = temporal::Layout<Channels>;
+
+    // 多重解像度ピラミッド（段0 = 本体）
+    using Levels = pyramid::Levels<NTheta, NR>;
+    static constexpr int kPyramidLevels = Levels::kCount;
+
+    template <int L>
+    using LevelMatrix = Eigen::Matrix<Scalar, Levels::template kTheta<L>, Levels::template kR<L>>;
+
+private:
+    using Storage = Eigen::Matrix<Scalar, kChannelSize, Temporal::kColumns>;
+
+    // ストレージ全体とチャネル境界が最大アライメントに揃う場合のみアラインドMapを使う
+    static constexpr int kMaxAlign = EIGEN_MAX_STATIC_ALIGN_BYTES;
+    static constexpr bool kChannelsAligned =
+        kMaxAlign > 0 &&
+        (sizeof(Scalar) * kChannelSize) % (kMaxAlign > 0 ? kMaxAlign : 1) == 0;
+
+public:
+    // チャネルビュー（ゼロコピー、ストレージ内部を直接参照）
+    static constexpr int kMapOptions = kChannelsAligned ? Eigen::AlignedMax : Eigen::Unaligned;
+    using ChannelMap = Eigen::Map<ChannelMatrix, kMapOptions>;
+    using ConstChannelMap = Eigen::Map<const ChannelMatrix, kMapOptions>;
+
+    // 全チャネル分のフィールド（バッチ勾配の出力）
+    using ChannelArray = std::array<ChannelMatrix, Channels>;
+
+    // 融合勾配カーネルの出力
+    struct GradientField {
+        ChannelMatrix theta;      // ∂/∂θ（周期境界）
+        ChannelMatrix r;          // ∂/∂r（Neumann境界）
+        ChannelMatrix magnitude;  // |∇|
+    };
+
+    // 版番号（チャネル書き込みごとに単調増加）
+    using Version = std::uint64_t;
 
     // コンストラクタ
-    SaliencyPolarMap() : data_(10, 12, 12) {
+    BasicSaliencyPolarMap() {
         data_.setZero();
+        uniform_.fill(true);
+    }
+
+    // チャネルアクセス（コピー）
+    auto get_channel(eph::ChannelID id) const -> ChannelMatrix {
+        return channel(id);
     }
 
-    // チャネルアクセス
-    auto get_channel(eph::ChannelID id) const -> Matrix12x12 {
-        return channel_to_matrix(static_cast<int>(id));
+    // 書き込みと同時に一様性を判定し、派生量を確定する
+    void set_channel(eph::ChannelID id, const ChannelMatrix& mat) {
+        mutable_channel(id) = mat;
+        const Scalar value = mat(0, 0);
+        if (std::isfinite(value) && (mat.array() == value).all()) {
+            mark_uniform(static_cast<int>(id), value);
+        }
+        update_derived(static_cast<int>(id));
     }
 
-    void set_channel(eph::ChannelID id, const Matrix12x12& mat) {
-        matrix_to_channel(static_cast<int>(id), mat);
+    // 定数で埋める（一様チャネルとして記録、判定の走査なし）
+    void fill_channel(eph::ChannelID id, Scalar value) {
+        mutable_channel(id).setConstant(value);
+        if (std::isfinite(value)) {
+            mark_uniform(static_cast<int>(id), value);
+        }
+        update_derived(static_cast<int>(id));
     }
 
-    // 境界条件を満たす勾配計算
+    // チャネルアクセス（ゼロコピービュー）
+    // 注: ビューはマップ本体より長く保持しないこと
+    auto channel(eph::ChannelID id) const -> ConstChannelMap {
+        return ConstChannelMap(channel_data(static_cast<int>(id)));
+    }
 
-    // θ方向勾配（周期境界）
-    auto gradient_theta(eph::ChannelID id) const -> Matrix12x12 {
-        using namespace eph::constants;
-        using namespace eph::math;
+    // 書き込み用ビュー: 取得時点でチャネルの版を進める（派生量の無効化、一様フラグ解除）
+    // ビュー経由の書き込みを終えるまで派生量を読まないこと（書き終えたら warm_cache() で確定）
+    auto mutable_channel(eph::ChannelID id) -> ChannelMap {
+        const int c = static_cast<int>(id);
+        ++versions_[c];
+        uniform_[channel_column(c)] = false;
+        return ChannelMap(channel_data(c));
+    }
 
-        auto channel = get_channel(id);
-        Matrix12x12 grad;
+    auto channel_version(eph::ChannelID id) const -> Version {
+        return versions_[static_cast<int>(id)];
+    }
 
-        for (int a = 0; a < N_THETA; ++a) {
-            for (int b = 0; b < N_R; ++b) {
-                // θ方向: 周期境界（a=0 と a=11 が隣接）
-                int a_plus = wrap_index(a + 1, N_THETA);
-                int a_minus = wrap_index(a - 1, N_THETA);
+    // 一様チャネルの値（全ビンが同一の有限値と分かっている場合のみ）
+    auto uniform_value(eph::ChannelID id) const -> std::optional<Scalar> {
+        const int column = channel_column(static_cast<int>(id));
+        if (!uniform_[column]) {
+            return std::nullopt;
+        }
+        return uniform_value_[column];
+    }
 
-                // 中心差分
-                grad(a, b) = (channel(a_plus, b) - channel(a_minus, b)) / (2.0 * DELTA_THETA);
-            }
+    auto is_zero_channel(eph::ChannelID id) const -> bool {
+        const auto value = uniform_value(id);
+        return value && *value == Scalar(0.0);
+    }
+
+    // 境界条件を満たす勾配計算（参照演算子、全ビン、ステンシルエンジンの列演算）
+
+    // θ方向勾配（周期境界）
+    auto gradient_theta(eph::ChannelID id) const -> ChannelMatrix {
+        if (uniform_value(id)) {
+            return ChannelMatrix::Zero();
         }
+
+        ChannelMatrix grad;
+        stencil::PolarDerivative::for_each_column<NTheta>(channel(id), [&](const auto& col) {
+            constexpr int b = std::decay_t<decltype(col)>::kColumn;
+            // 中心差分（a=0 と a=NTheta-1 が隣接）
+            grad.col(b) = ((col.template at<1, 0>() - col.template at<-1, 0>()) /
+                           (Scalar(2.0) * kDeltaTheta)).matrix();
+        });
         return grad;
     }
 
     // r方向勾配（Neumann境界）
-    auto gradient_r(eph::ChannelID id) const -> Matrix12x12 {
-        using namespace eph::constants;
-        using namespace eph::math;
-
-        auto channel = get_channel(id);
-        Matrix12x12 grad;
-
-        for (int a = 0; a < N_THETA; ++a) {
-            for (int b = 0; b < N_R; ++b) {
-                if (b == 0 || b == N_R - 1) {
-                    // r方向: Neumann境界（端でゼロ勾配）
-                    grad(a, b) = 0.0;
-                } else {
-                    // 内部: 中心差分
-                    int b_plus = clamp_index(b + 1, N_R);
-                    int b_minus = clamp_index(b - 1, N_R);
-                    grad(a, b) = (channel(a, b_plus) - channel(a, b_minus)) / 2.0;
-                }
-            }
+    auto gradient_r(eph::ChannelID id) const -> ChannelMatrix {
+        if (uniform_value(id)) {
+            return ChannelMatrix::Zero();
         }
+
+        ChannelMatrix grad;
+        stencil::PolarDerivative::for_each_column<NTheta>(channel(id), [&](const auto& col) {
+            using Col = std::decay_t<decltype(col)>;
+            constexpr int b = Col::kColumn;
+            if constexpr (Col::template kSymmetricR<1>) {
+                // 端でゼロ勾配
+                grad.col(b).setZero();
+            } else {
+                // 内部: 中心差分
+                grad.col(b) = ((col.template at<0, 1>() - col.template at<0, -1>()) / Scalar(2.0)).matrix();
+            }
+        });
         return grad;
     }
 
-    // 勾配の大きさ
-    auto gradient_magnitude(eph::ChannelID id) const -> Matrix12x12 {
-        auto grad_theta = gradient_theta(id);
-        auto grad_r = gradient_r(id);
+    // 勾配の大きさ（融合カーネル、一様チャネルは0）
+    auto gradient_magnitude(eph::ChannelID id) const -> ChannelMatrix {
+        ChannelMatrix mag;
+        if (uniform_value(id)) {
+            mag.setZero();
+        } else {
+            kernel::gradient_magnitude(channel(id), mag);
+        }
+        return mag;
+    }
+
+    // ⟨|∇SPM|⟩ 視野内平均（行為選択のEpistemic項で使用、確定済みなら保持値）
+    auto gradient_magnitude_mean(eph::ChannelID id) const -> Scalar {
+        return gradient_magnitude_mean(id, 0);
+    }
+
+    // ピラミッド段 level での ⟨|∇SPM|⟩（段0は上と同一）
+    auto gradient_magnitude_mean(eph::ChannelID id, int level) const -> Scalar {
+        assert(level >= 0 && level < kPyramidLevels);
+        const int c = static_cast<int>(id);
+        if (derived_version_[c] == versions_[c]) {
+            return derived_[c].gradient_mean[level];
+        }
+        return compute_gradient_mean(c, level);
+    }
 
-        Matrix12x12 mag;
-        for (int a = 0; a < 12; ++a) {
-            for (int b = 0; b < 12; ++b) {
-                mag(a, b) = std::sqrt(grad_theta(a, b) * grad_theta(a, b) +
-                                       grad_r(a, b) * grad_r(a, b));
+    // ピラミッド段 L（1 ≤ L < kPyramidLevels）のチャネル（一様チャネルは定数）
+    template <int L>
+    auto pyramid_level(eph::ChannelID id) const -> LevelMatrix<L> {
+        static_assert(L >= 1 && L < kPyramidLevels, "Pyramid level out of range");
+        LevelMatrix<L> level;
+        if (const auto value = uniform_value(id)) {
+            level.setConstant(*value);
+        } else if constexpr (L == 1) {
+            pyramid::downsample(channel(id), level);
+        } else {
+            pyramid::downsample(pyramid_level<L - 1>(id), level);
+        }
+        return level;
+    }
+
+    // チャネルの視野内平均（確定済みなら保持値）
+    auto channel_mean(eph::ChannelID id) const -> Scalar {
+        const int c = static_cast<int>(id);
+        if (derived_version_[c] == versions_[c]) {
+            return derived_[c].mean;
+        }
+        return compute_mean(c);
+    }
+
+    // 派生量を確定（mutable_channel() / update_temporal() で書いたチャネル、確定済みは走査しない）
+    void warm_cache(eph::ChannelID id) {
+        const int c = static_cast<int>(id);
+        if (derived_version_[c] != versions_[c]) {
+            update_derived(c);
+        }
+    }
+
+    void warm_cache() {
+        for (int c = 0; c < Channels; ++c) {
+            warm_cache(static_cast<eph::ChannelID>(c));
+        }
+    }
+
+    // θ勾配・r勾配・大きさを1パスで計算
+    auto gradient(eph::ChannelID id) const -> GradientField {
+        GradientField g;
+        if (uniform_value(id)) {
+            g.theta.setZero();
+            g.r.setZero();
+            g.magnitude.setZero();
+        } else {
+            kernel::fused_gradient(channel(id), g.theta, g.r, g.magnitude);
+        }
+        return g;
+    }
+
+    // 全チャネルの勾配の大きさ（連続ストレージをチャネル順に一括走査、一様チャネルは0）
+    void gradient_magnitude_all(ChannelArray& out) const {
+        for (int c = 0; c < Channels; ++c) {
+            if (uniform_[channel_column(c)]) {
+                out[c].setZero();
+            } else {
+                kernel::gradient_magnitude(ConstChannelMap(channel_data(c)), out[c]);
             }
         }
-        return mag;
     }
 
-    // ユーティリティ
+    // 時間チャネル
+
+    // フレーム開始: 占有の表裏を入れ替える（前フレームの占有を保持したまま F0 を書ける）
+    void begin_frame() {
+        static_assert(Temporal::kEnabled, "Temporal channels need R0/F0/F5");
+        occupancy_swapped_ = !occupancy_swapped_;
+        ++versions_[Temporal::kOccupancy];
+    }
+
+    // 前フレームの占有（begin_frame() 前の F0）
+    auto previous_occupancy() const -> ConstChannelMap {
+        static_assert(Temporal::kEnabled, "Temporal channels need R0/F0/F5");
+        return ConstChannelMap(column_data(Temporal::previous_occupancy_column(occupancy_swapped_)));
+    }
+
+    // 現/前フレームの占有から R0・F5 を増分更新
+    void update_temporal() {
+        static_assert(Temporal::kEnabled, "Temporal channels need R0/F0/F5");
+        temporal::update<kChannelSize>(
+            channel_data(Temporal::kOccupancy),
+            column_data(Temporal::previous_occupancy_column(occupancy_swapped_)),
+            column_data(Temporal::kMeanColumn),
+            channel_data(Temporal::kDelta),
+            channel_data(Temporal::kStability));
+        ++versions_[Temporal::kDelta];
+        ++versions_[Temporal::kStability];
+        uniform_[channel_column(Temporal::kDelta)] = false;
+        uniform_[channel_column(Temporal::kStability)] = false;
+    }
+
+    static constexpr auto has_temporal_channels() -> bool { return Temporal::kEnabled; }
+
+    // ユーティリティ（時間チャネルの履歴もゼロに戻る）
     void zero_all() {
         data_.setZero();
+        for (auto& v : versions_) {
+            ++v;
+        }
+        uniform_.fill(true);
+        uniform_value_.fill(Scalar(0.0));
+        derived_.fill(Derived{});
+        derived_version_ = versions_;
     }
 
-    auto channel_count() const -> int { return 10; }
-    auto theta_count() const -> int { return 12; }
-    auto r_count() const -> int { return 12; }
+    static constexpr auto channel_count() -> int { return Channels; }
+    static constexpr auto theta_count() -> int { return NTheta; }
+    static constexpr auto r_count() -> int { return NR; }
 
 private:
-    Tensor3 data_;  // (10, 12, 12) = (C, θ, r)
-
-    // 内部ヘルパー
-    auto channel_to_matrix(int channel_idx) const -> Matrix12x12 {
-        Matrix12x12 mat;
-        for (int a = 0; a < 12; ++a) {
-            for (int b = 0; b < 12; ++b) {
-                mat(a, b) = data_(channel_idx, a, b);
+    static constexpr Scalar kDeltaTheta = static_cast<Scalar>(2.0 * constants::PI / NTheta);
+
+    Storage data_;  // (θ·r, C + 時間チャネル追加列) 列優先 → チャネル単位で連続
+    bool occupancy_swapped_ = false;  // 占有の表裏（begin_frame() で反転）
+
+    // 派生量（チャネル平均と段ごとの ⟨|∇|⟩、書き込み時に確定）
+    struct Derived {
+        Scalar mean = Scalar(0.0);
+        std::array<Scalar, kPyramidLevels> gradient_mean{};
+    };
+
+    // 版番号と確定済み派生量（初期状態の全ゼロチャネルは確定済み: 平均・勾配とも0）
+    std::array<Version, Channels> versions_{};
+    std::array<Derived, Channels> derived_{};
+    std::array<Version, Channels> derived_version_{};
+
+    // 一様フラグ（格納列ごと）
+    std::array<bool, Temporal::kColumns> uniform_{};
+    std::array<Scalar, Temporal::kColumns> uniform_value_{};
+
+    void mark_uniform(int channel_idx, Scalar value) {
+        const int column = channel_column(channel_idx);
+        uniform_[column] = true;
+        uniform_value_[column] = value;
+    }
+
+    // チャネル平均（一様チャネルはその値）
+    auto compute_mean(int c) const -> Scalar {
+        const auto value = uniform_value(static_cast<eph::ChannelID>(c));
+        return value ? *value : visible_mean(ConstChannelMap(channel_data(c)));
+    }
+
+    // 段 level での ⟨|∇|⟩（一様チャネルは0）
+    auto compute_gradient_mean(int c, int level) const -> Scalar {
+        const auto id = static_cast<eph::ChannelID>(c);
+        if (uniform_value(id)) {
+            return Scalar(0.0);
+        }
+        if (level == 0) {
+            return visible_mean(gradient_magnitude(id));
+        }
+        if constexpr (kPyramidLevels > 1) {
+            const LevelMatrix<1> level1 = pyramid_level<1>(id);
+            if (level == 1) {
+                return pyramid::gradient_magnitude_mean(level1, 1);
+            }
+            if constexpr (kPyramidLevels > 2) {
+                LevelMatrix<2> level2;
+                pyramid::downsample(level1, level2);
+                return pyramid::gradient_magnitude_mean(level2, 2);
             }
         }
-        return mat;
+        return Scalar(0.0);
     }
 
-    void matrix_to_channel(int channel_idx, const Matrix12x12& mat) {
-        for (int a = 0; a < 12; ++a) {
-            for (int b = 0; b < 12; ++b) {
-                data_(channel_idx, a, b) = mat(a, b);
-            }
+    // チャネル c の派生量を確定
+    void update_derived(int c) {
+        derived_[c].mean = compute_mean(c);
+        for (int level = 0; level < kPyramidLevels; ++level) {
+            derived_[c].gradient_mean[level] = compute_gradient_mean(c, level);
         }
+        derived_version_[c] = versions_[c];
+    }
+
+    // 内部ヘルパー: チャネルの格納列と先頭ポインタ（各チャネルは θ×r 要素の連続領域）
+    auto channel_column(int channel_idx) const -> int {
+        return Temporal::column(channel_idx, occupancy_swapped_);
+    }
+
+    auto channel_data(int channel_idx) const -> const Scalar* {
+        return column_data(channel_column(channel_idx));
+    }
+
+    auto channel_data(int channel_idx) -> Scalar* {
+        return column_data(channel_column(channel_idx));
+    }
+
+    auto column_data(int column) const -> const Scalar* {
+        return data_.data() + column * kChannelSize;
+    }
+
+    auto column_data(int column) -> Scalar* {
+        return data_.data() + column * kChannelSize;
     }
 };
 
+// 標準構成: 10チャネル × 12×12（EPH v2.1）
+using SaliencyPolarMap = BasicSaliencyPolarMap<
+    constants::N_CHANNELS, constants::N_THETA, constants::N_R, eph::Scalar>;
+
 }  // namespace eph::spm
 
 #endif  // EPH_SPM_SALIENCY_POLAR_MAP_HPP
@@ -0,0 +1,198 @@
+#ifndef EPH_SPM_SEPARABLE_BLUR_HPP
+#define EPH_SPM_SEPARABLE_BLUR_HPP
+
+#include <Eigen/Core>
+#include <array>
+#include <type_traits>
+#include <utility>
+#include "eph_core/types.hpp"
+#include "eph_spm/stencil.hpp"
+
+namespace eph::spm::blur {
+
+/**
+ * @brief 二項係数カーネル（コンパイル時生成）
+ *
+ * 重み C(Order, k)、k = 0..Order、合計 2^Order。分散 Order/4 のガウシアン近似
+ * （σ = √Order / 2 [ビン]）で、重みが整数のため正規化は最後の1回の除算のみ。
+ *
+ * | Order | 半径 | σ [ビン] |
+ * |-------|------|----------|
+ * | 2     | 1    | 0.71     |
+ * | 4     | 2    | 1.00     |
+ * | 8     | 4    | 1.41     |
+ * | 16    | 8    | 2.00     |
+ *
+ * @tparam Order 二項係数の次数（偶数）
+ */
+template <int Order>
+struct Binomial {
+    static_assert(Order >= 2 && Order % 2 == 0, "Binomial kernel order must be even and >= 2");
+
+    static constexpr int kRadius = Order / 2;
+    static constexpr int kTaps = Order + 1;
+
+    static constexpr auto make() -> std::array<int, kTaps> {
+        std::array<int, kTaps> w{};
+        w[0] = 1;
+        for (int n = 1; n <= Order; ++n) {
+            for (int k = n; k > 0; --k) {
+                w[k] += w[k - 1];
+            }
+        }
+        return w;
+    }
+
+    static constexpr std::array<int, kTaps> kWeights = make();
+    static constexpr int kSum = 1 << Order;
+
+    // オフセット d ∈ [-kRadius, kRadius] の重み
+    static constexpr auto weight(int d) -> Scalar {
+        return static_cast<Scalar>(kWeights[d + kRadius]);
+    }
+};
+
+// 1列分の r 方向積和（タップ順は dr = -R → R）
+template <typename Kernel, typename Col, int... Taps>
+inline auto pass_r(const Col& col, std::integer_sequence<int, Taps...>) -> typename Col::Values {
+    typename Col::Values sum = Col::Values::Zero();
+    ((sum += Kernel::weight(Taps - Kernel::kRadius) * col.template at<0, Taps - Kernel::kRadius>()), ...);
+    return sum;
+}
+
+// 1列分の θ 方向積和（タップ順は dθ = -R → R）
+template <typename Kernel, typename Col, int... Taps>
+inline auto pass_theta(const Col& col, std::integer_sequence<int, Taps...>) -> typename Col::Values {
+    typename Col::Values sum = Col::Values::Zero();
+    ((sum += Kernel::weight(Taps - Kernel::kRadius) * col.template at<Taps - Kernel::kRadius, 0>()), ...);
+    return sum;
+}
+
+/**
+ * @brief 分離可能ガウシアンブラー（θ周期・r Neumann）
+ *
+ * 2次元カーネル w(dθ)·w(dr) を r 方向・θ 方向の1次元パス2回に分ける
+ * （1ビンあたり (2R+1)² 回ではなく 2(2R+1) 回の積和）。
+ * 各パスはステンシルエンジン（stencil::PolarSmoothing）の列演算で、
+ * r 列ごとに θ 方向の列ベクトルとしてSIMD処理する。
+ *
+ * 1. r パス: 全 θ 行について t(a, b) = Σ_dr w(dr)·in(a, b+dr)（端セル複製）
+ * 2. θ パス: 出力行 [0, Rows) について out(a, b) = Σ_dθ w(dθ)·t(a+dθ, b)（周期）
+ * 3. 正規化: 2^(2·Order) で1回だけ割る
+ *
+ * θ パスは出力行から θ 方向に半径 R 以内の行しか読まないため、
+ * 入力はその行だけ有効であればよい（needed_row()）。
+ *
+ * @tparam Order 二項カーネルの次数
+ * @tparam Rows 出力する行数（先頭 Rows 行、残りの行は変更しない）
+ * @param input 入力フィールド（θ×r、固定長）
+ * @param output 出力フィールド
+ */
+template <int Order, int Rows, typename InDerived, typename OutDerived>
+inline void separable(const Eigen::MatrixBase<InDerived>& input, Eigen::MatrixBase<OutDerived>& output) {
+    using Kernel = Binomial<Order>;
+    using Field = Eigen::Matrix<typename InDerived::Scalar,
+                                InDerived::RowsAtCompileTime, InDerived::ColsAtCompileTime>;
+    constexpr int NT = InDerived::RowsAtCompileTime;
+    using Taps = std::make_integer_sequence<int, Kernel::kTaps>;
+
+    // 1. r パス（全行）
+    Field smoothed_r;
+    stencil::PolarSmoothing::for_each_column<NT>(input, [&](const auto& col) {
+        constexpr int b = std::decay_t<decltype(col)>::kColumn;
+        smoothed_r.col(b) = pass_r<Kernel>(col, Taps{}).matrix();
+    });
+
+    // 2. θ パス（出力行のみ）+ 3. 正規化
+    constexpr Scalar norm = Scalar(1.0) / (Scalar(Kernel::kSum) * Scalar(Kernel::kSum));
+    stencil::PolarSmoothing::for_each_column<Rows>(smoothed_r, [&](const auto& col) {
+        constexpr int b = std::decay_t<decltype(col)>::kColumn;
+        output.col(b).template head<Rows>() = (pass_theta<Kernel>(col, Taps{}) * norm).matrix();
+    });
+}
+
+// 1列分の2次元積和（タップ順は dθ 外側・dr 内側、いずれも -R → R）
+template <typename Kernel, typename Col, int... Taps>
+inline auto pass_direct(const Col& col, std::integer_sequence<int, Taps...>) -> typename Col::Values {
+    constexpr int W = Kernel::kTaps;
+    typename Col::Values sum = Col::Values::Zero();
+    ((sum += Kernel::weight(Taps / W - Kernel::kRadius) * Kernel::weight(Taps % W - Kernel::kRadius) *
+             col.template at<Taps / W - Kernel::kRadius, Taps % W - Kernel::kRadius>()), ...);
+    return sum;
+}
+
+/**
+ * @brief 2次元カーネルの直接積和（separable() と同じ重み・境界）
+ *
+ * 1ビンあたり (2R+1)² 回の積和。半径1（Order = 2）では separable() の
+ * 2·3 回に対して 3×3 = 9 回と差が小さく、丸め順序を従来の3×3ステンシルと
+ * 揃えたい場合に使う。正規化は 2^(2·Order) で1回だけ割る。
+ */
+template <int Order, int Rows, typename InDerived, typename OutDerived>
+inline void direct(const Eigen::MatrixBase<InDerived>& input, Eigen::MatrixBase<OutDerived>& output) {
+    using Kernel = Binomial<Order>;
+    using Taps = std::make_integer_sequence<int, Kernel::kTaps * Kernel::kTaps>;
+    constexpr Scalar sum = Scalar(Kernel::kSum) * Scalar(Kernel::kSum);
+
+    stencil::PolarSmoothing::for_each_column<Rows>(input, [&](const auto& col) {
+        constexpr int b = std::decay_t<decltype(col)>::kColumn;
+        output.col(b).template head<Rows>() = (pass_direct<Kernel>(col, Taps{}) / sum).matrix();
+    });
+}
+
+/**
+ * @brief 定数フィールドの separable()（解析解）
+ *
+ * 周期境界・Neumann境界とも近傍は同じ値なので全セルが同一の結果になる。
+ * separable() と同じ順序で積和するため、一般経路の結果とビット単位で一致する。
+ */
+template <int Order>
+inline auto uniform_separable(Scalar value) -> Scalar {
+    using Kernel = Binomial<Order>;
+    constexpr Scalar norm = Scalar(1.0) / (Scalar(Kernel::kSum) * Scalar(Kernel::kSum));
+
+    Scalar smoothed_r = 0.0;
+    for (int d = -Kernel::kRadius; d <= Kernel::kRadius; ++d) {
+        smoothed_r += Kernel::weight(d) * value;
+    }
+    Scalar sum = 0.0;
+    for (int d = -Kernel::kRadius; d <= Kernel::kRadius; ++d) {
+        sum += Kernel::weight(d) * smoothed_r;
+    }
+    return sum * norm;
+}
+
+/**
+ * @brief 定数フィールドの direct()（解析解、direct() と同じ順序で積和）
+ */
+template <int Order>
+inline auto uniform_direct(Scalar value) -> Scalar {
+    using Kernel = Binomial<Order>;
+    constexpr Scalar sum_weights = Scalar(Kernel::kSum) * Scalar(Kernel::kSum);
+
+    Scalar sum = 0.0;
+    for (int da = -Kernel::kRadius; da <= Kernel::kRadius; ++da) {
+        for (int db = -Kernel::kRadius; db <= Kernel::kRadius; ++db) {
+            sum += Kernel::weight(da) * Kernel::weight(db) * value;
+        }
+    }
+    return sum / sum_weights;
+}
+
+/**
+ * @brief θ パス（または direct()）が読む行か（出力行 [0, Rows) から周期距離 R 以内）
+ */
+template <int Order, int NT, int Rows>
+constexpr auto needed_row(int a) -> bool {
+    constexpr int R = Binomial<Order>::kRadius;
+    if (a < Rows) {
+        return true;
+    }
+    const int below = a - (Rows - 1);   // 出力の最終行からの距離
+    const int above = NT - a;           // 周期で行0までの距離
+    return below <= R || above <= R;
+}
+
+}  // namespace eph::spm::blur
+
+#endif  // EPH_SPM_SEPARABLE_BLUR_HPP
@@ -0,0 +1,285 @@
+#ifndef EPH_SPM_SPM_BATCH_HPP
+#define EPH_SPM_SPM_BATCH_HPP
+
+#include <Eigen/Core>
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include "eph_core/types.hpp"
+#include "eph_core/constants.hpp"
+#include "eph_spm/gradient_kernel.hpp"
+#include "eph_spm/polar_grid.hpp"
+#include "eph_spm/pyramid.hpp"
+#include "eph_spm/saliency_polar_map.hpp"
+
+namespace eph::spm {
+
+/**
+ * @brief 1エージェント分のSPMへの非所有ビュー
+ *
+ * SpmBatch の連続バッファ上の (C, θ, r) ブロックを参照する。レイアウトは
+ * BasicSaliencyPolarMap と同一（チャネル単位で連続、各チャネルは θ×r 列優先）。
+ * HazeEstimator / ActionSelector / EPHAgent::update は SaliencyPolarMap と同じく
+ * このビューを受け取れる。
+ *
+ * 派生量はキャッシュせず、読み出しのたびに融合カーネルで計算する。
+ * 一様チャネルのフラグも持たない（uniform_value() は常に nullopt、一般経路で計算）。
+ * 時間チャネル（R0, F5）の占有表裏はバッチ全体で共有し、ビューが番号を持ち運ぶ。
+ *
+ * @tparam kMutable true のとき書き込みAPIを提供
+ */
+template <int Channels, int NTheta, int NR, typename ScalarT, bool kMutable>
+class BasicSpmView {
+public:
+    using Map = BasicSaliencyPolarMap<Channels, NTheta, NR, ScalarT>;
+    using Scalar = ScalarT;
+    using ChannelMatrix = typename Map::ChannelMatrix;
+    using ChannelMap = typename Map::ChannelMap;
+    using ConstChannelMap = typename Map::ConstChannelMap;
+    using GradientField = typename Map::GradientField;
+    using Temporal = typename Map::Temporal;
+    using Pointer = std::conditional_t<kMutable, Scalar*, const Scalar*>;
+
+    static constexpr int kChannels = Channels;
+    static constexpr int kNTheta = NTheta;
+    static constexpr int kNR = NR;
+    static constexpr int kChannelSize = NTheta * NR;
+
+    /**
+     * @param data エージェントブロック先頭
+     * @param occupancy_swapped 占有の表裏（BasicSpmBatch::begin_frame() で反転）
+     */
+    explicit BasicSpmView(Pointer data, bool occupancy_swapped = false)
+        : data_(data), occupancy_swapped_(occupancy_swapped) {}
+
+    // 書き込み可能ビュー → 読み取り専用ビューへの変換
+    template <bool M = kMutable, typename = std::enable_if_t<M>>
+    operator BasicSpmView<Channels, NTheta, NR, ScalarT, false>() const {
+        return BasicSpmView<Channels, NTheta, NR, ScalarT, false>(data_, occupancy_swapped_);
+    }
+
+    // チャネルアクセス
+    auto channel(eph::ChannelID id) const -> ConstChannelMap {
+        return ConstChannelMap(channel_data(static_cast<int>(id)));
+    }
+
+    auto get_channel(eph::ChannelID id) const -> ChannelMatrix {
+        return channel(id);
+    }
+
+    template <bool M = kMutable, typename = std::enable_if_t<M>>
+    auto mutable_channel(eph::ChannelID id) const -> ChannelMap {
+        return ChannelMap(channel_data(static_cast<int>(id)));
+    }
+
+    template <bool M = kMutable, typename = std::enable_if_t<M>>
+    void set_channel(eph::ChannelID id, const ChannelMatrix& mat) const {
+        mutable_channel(id) = mat;
+    }
+
+    // マップ全体をこのビューへコピー
+    template <bool M = kMutable, typename = std::enable_if_t<M>>
+    void assign(const Map& map) const {
+        for (int c = 0; c < Channels; ++c) {
+            const auto id = static_cast<eph::ChannelID>(c);
+            mutable_channel(id) = map.channel(id);
+        }
+    }
+
+    auto uniform_value(eph::ChannelID /*id*/) const -> std::optional<Scalar> {
+        return std::nullopt;
+    }
+
+    // 派生量（キャッシュなし）
+    auto gradient_magnitude(eph::ChannelID id) const -> ChannelMatrix {
+        ChannelMatrix mag;
+        kernel::gradient_magnitude(channel(id), mag);
+        return mag;
+    }
+
+    auto gradient_magnitude_mean(eph::ChannelID id) const -> Scalar {
+        return visible_mean(gradient_magnitude(id));
+    }
+
+    // ピラミッド段 level での ⟨|∇SPM|⟩（段はその場で2×2平均プーリングして作る）
+    auto gradient_magnitude_mean(eph::ChannelID id, int level) const -> Scalar {
+        assert(level >= 0 && level < Map::kPyramidLevels);
+        if (level == 0) {
+            return gradient_magnitude_mean(id);
+        }
+        if constexpr (Map::kPyramidLevels > 1) {
+            typename Map::template LevelMatrix<1> level1;
+            pyramid::downsample(channel(id), level1);
+            if (level == 1) {
+                return pyramid::gradient_magnitude_mean(level1, 1);
+            }
+            if constexpr (Map::kPyramidLevels > 2) {
+                typename Map::template LevelMatrix<2> level2;
+                pyramid::downsample(level1, level2);
+                return pyramid::gradient_magnitude_mean(level2, 2);
+            }
+        }
+        return gradient_magnitude_mean(id);
+    }
+
+    auto channel_mean(eph::ChannelID id) const -> Scalar {
+        return visible_mean(channel(id));
+    }
+
+    auto gradient(eph::ChannelID id) const -> GradientField {
+        GradientField g;
+        kernel::fused_gradient(channel(id), g.theta, g.r, g.magnitude);
+        return g;
+    }
+
+    // 時間チャネル（手順は BasicSaliencyPolarMap と同じ。begin_frame() はバッチ側で行う）
+    auto previous_occupancy() const -> ConstChannelMap {
+        static_assert(Temporal::kEnabled, "Temporal channels need R0/F0/F5");
+        return ConstChannelMap(data_ + Temporal::previous_occupancy_column(occupancy_swapped_) * kChannelSize);
+    }
+
+    template <bool M = kMutable, typename = std::enable_if_t<M>>
+    void update_temporal() const {
+        static_assert(Temporal::kEnabled, "Temporal channels need R0/F0/F5");
+        temporal::update<kChannelSize>(
+            channel_data(Temporal::kOccupancy),
+            data_ + Temporal::previous_occupancy_column(occupancy_swapped_) * kChannelSize,
+            data_ + Temporal::kMeanColumn * kChannelSize,
+            channel_data(Temporal::kDelta),
+            channel_data(Temporal::kStability));
+    }
+
+    auto data() const -> Pointer { return data_; }
+
+    static constexpr auto channel_count() -> int { return Channels; }
+    static constexpr auto theta_count() -> int { return NTheta; }
+    static constexpr auto r_count() -> int { return NR; }
+
+private:
+    Pointer data_;
+    bool occupancy_swapped_;
+
+    auto channel_data(int c) const -> Pointer {
+        return data_ + Temporal::column(c, occupancy_swapped_) * kChannelSize;
+    }
+};
+
+/**
+ * @brief 群全体のSPMを1つのアラインドバッファに格納するコンテナ
+ *
+ * N×C×θ×r の値をエージェント優先（各エージェントのブロックが連続）で保持する。
+ * エージェント i のブロックは BasicSaliencyPolarMap と同一レイアウトで、
+ * agent(i) が返すビューをそのまま HazeEstimator / ActionSelector に渡せる。
+ *
+ * ## メモリレイアウト
+ * (θ·r·C') × N の列優先行列。1列 = 1エージェント（C' は時間チャネルの追加列を含む列数）。
+ * - N個の小さなヒープ確保が不要（キャッシュミス削減）
+ * - 全エージェント走査はバッファ先頭から単位ストライド
+ * - channel_block(id) で「全エージェントの同一チャネル」を θ·r × N 行列として参照可能
+ */
+template <int Channels, int NTheta, int NR, typename ScalarT = eph::Scalar>
+class BasicSpmBatch {
+public:
+    using Scalar = ScalarT;
+    using Map = BasicSaliencyPolarMap<Channels, NTheta, NR, ScalarT>;
+    using View = BasicSpmView<Channels, NTheta, NR, ScalarT, true>;
+    using ConstView = BasicSpmView<Channels, NTheta, NR, ScalarT, false>;
+    using ChannelMatrix = typename Map::ChannelMatrix;
+    using Temporal = typename Map::Temporal;
+
+    static constexpr int kChannelSize = NTheta * NR;
+    static constexpr int kAgentSize = kChannelSize * Temporal::kColumns;
+
+    using Storage = Eigen::Matrix<Scalar, kAgentSize, Eigen::Dynamic>;
+    using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+
+    // 全エージェントの同一チャネル（θ·r × N、列ストライド = kAgentSize）
+    using ChannelBlock = Eigen::Map<Eigen::Matrix<Scalar, kChannelSize, Eigen::Dynamic>,
+                                    Eigen::Unaligned, Eigen::OuterStride<kAgentSize>>;
+    using ConstChannelBlock = Eigen::Map<const Eigen::Matrix<Scalar, kChannelSize, Eigen::Dynamic>,
+                                         Eigen::Unaligned, Eigen::OuterStride<kAgentSize>>;
+
+    /**
+     * @brief コンストラクタ
+     * @param n_agents エージェント数
+     */
+    explicit BasicSpmBatch(std::size_t n_agents = 0)
+        : data_(Storage::Zero(kAgentSize, static_cast<Eigen::Index>(n_agents))) {}
+
+    void resize(std::size_t n_agents) {
+        data_.setZero(kAgentSize, static_cast<Eigen::Index>(n_agents));
+    }
+
+    auto size() const -> std::size_t {
+        return static_cast<std::size_t>(data_.cols());
+    }
+
+    // エージェント i のビュー
+    auto agent(std::size_t i) -> View {
+        assert(i < size());
+        return View(data_.col(static_cast<Eigen::Index>(i)).data(), occupancy_swapped_);
+    }
+
+    auto agent(std::size_t i) const -> ConstView {
+        assert(i < size());
+        return ConstView(data_.col(static_cast<Eigen::Index>(i)).data(), occupancy_swapped_);
+    }
+
+    // 全エージェントの同一チャネル（バッチカーネル用、各列は連続）
+    auto channel_block(eph::ChannelID id) -> ChannelBlock {
+        return ChannelBlock(data_.data() + channel_offset(id), kChannelSize, data_.cols());
+    }
+
+    auto channel_block(eph::ChannelID id) const -> ConstChannelBlock {
+        return ConstChannelBlock(data_.data() + channel_offset(id), kChannelSize, data_.cols());
+    }
+
+    // 時間チャネル: 全エージェントの占有表裏を一括で入れ替える（コピーなし）
+    void begin_frame() {
+        static_assert(Temporal::kEnabled, "Temporal channels need R0/F0/F5");
+        occupancy_swapped_ = !occupancy_swapped_;
+    }
+
+    // 全エージェントの R0・F5 を増分更新
+    void update_temporal() {
+        for (std::size_t i = 0; i < size(); ++i) {
+            agent(i).update_temporal();
+        }
+    }
+
+    // 全エージェントの ⟨|∇SPM|⟩（視野内平均）を1回の単位ストライド走査で計算
+    void gradient_magnitude_mean_all(eph::ChannelID id, Vector& out) const {
+        out.resize(data_.cols());
+        ChannelMatrix mag;
+        for (Eigen::Index i = 0; i < data_.cols(); ++i) {
+            kernel::gradient_magnitude(agent(static_cast<std::size_t>(i)).channel(id), mag);
+            out(i) = visible_mean(mag);
+        }
+    }
+
+    void zero_all() {
+        data_.setZero();
+    }
+
+    auto data() -> Scalar* { return data_.data(); }
+    auto data() const -> const Scalar* { return data_.data(); }
+
+private:
+    Storage data_;  // (θ·r·C') × N 列優先
+    bool occupancy_swapped_ = false;  // 占有の表裏（全エージェント共通）
+
+    auto channel_offset(eph::ChannelID id) const -> int {
+        return Temporal::column(static_cast<int>(id), occupancy_swapped_) * kChannelSize;
+    }
+};
+
+// 標準構成（10チャネル × 12×12）
+using SpmBatch = BasicSpmBatch<
+    constants::N_CHANNELS, constants::N_THETA, constants::N_R, eph::Scalar>;
+using SpmView = SpmBatch::View;
+using SpmConstView = SpmBatch::ConstView;
+
+}  // namespace eph::spm
+
+#endif  // EPH_SPM_SPM_BATCH_HPP
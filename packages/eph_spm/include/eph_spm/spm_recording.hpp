@@ -0,0 +1,328 @@
+#ifndef EPH_SPM_SPM_RECORDING_HPP
+#define EPH_SPM_SPM_RECORDING_HPP
+
+#include <Eigen/Core>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "eph_core/types.hpp"
+#include "eph_core/constants.hpp"
+#include "eph_spm/saliency_polar_map.hpp"
+#include "eph_spm/spm_batch.hpp"
+
+namespace eph::spm {
+
+/**
+ * @brief SPM記録ファイルのヘッダ（64バイト固定、ネイティブエンディアン）
+ *
+ * ## ファイル形式
+ * [ヘッダ 64B][フレーム 0][フレーム 1]...
+ *
+ * フレーム = n_agents 個のエージェントブロック（エージェント順）。
+ * エージェントブロック = channels 個のチャネル（ChannelID 順）、
+ * 各チャネルは θ×r 列優先の scalar_bytes 幅の値 n_theta·n_r 個。
+ * つまりブロックは BasicSaliencyPolarMap のチャネル部分と同一レイアウトで、
+ * mmap した領域をそのまま読み取り専用ビューとして参照できる。
+ *
+ * 時間チャネルの作業列（占有の裏バッファ・指数移動平均）は記録しない
+ * （R0, F5 自体はチャネルとして記録される）。
+ */
+struct SpmRecordingHeader {
+    static constexpr char kMagic[8] = {'E', 'P', 'H', 'S', 'P', 'M', 'R', 'C'};
+    static constexpr std::uint32_t kVersion = 1;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t scalar_bytes;
+    std::uint32_t channels;
+    std::uint32_t n_theta;
+    std::uint32_t n_r;
+    std::uint32_t reserved;
+    std::uint64_t n_agents;
+    std::uint64_t n_frames;
+    double dt;  // 記録時のタイムステップ [s]
+    std::uint8_t padding[8];
+};
+
+static_assert(sizeof(SpmRecordingHeader) == 64, "SPM recording header must be 64 bytes");
+static_assert(EIGEN_MAX_STATIC_ALIGN_BYTES == 0 ||
+              sizeof(SpmRecordingHeader) % EIGEN_MAX_STATIC_ALIGN_BYTES == 0,
+              "Header size keeps agent blocks aligned in the mapped file");
+
+/**
+ * @brief エージェントごとのSPM系列をバイナリ記録するライタ
+ *
+ * 1フレームは append_frame()（バッチ一括）か、append_agent() を
+ * エージェント順に n_agents 回呼んで書く。ヘッダのフレーム数は通常 close() で確定する
+ * （フレームごとにヘッダへ書き戻すとシークが挟まり、記録経路が重くなるため）。
+ * close() せずに終了するプロセス（サーバなど）は frame_count_interval を指定すると、
+ * その間隔ごとにヘッダのフレーム数を書き戻し、終了時点までの記録を読めるようにできる。
+ *
+ * ## 使用例
+ * ```cpp
+ * SpmRecorder recorder("run.spm", swarm.size(), dt);
+ * for (int t = 0; t < steps; ++t) {
+ *     rasterizer.rasterize(swarm, perception);
+ *     recorder.append_frame(perception);
+ *     swarm.update_all_agents(perception, dt);
+ * }
+ * recorder.close();
+ * ```
+ */
+template <int Channels, int NTheta, int NR, typename ScalarT = eph::Scalar>
+class BasicSpmRecorder {
+public:
+    using Scalar = ScalarT;
+    using Batch = BasicSpmBatch<Channels, NTheta, NR, ScalarT>;
+
+    static constexpr int kChannelSize = NTheta * NR;
+
+    /**
+     * @brief 記録ファイルを作成（既存ファイルは上書き）
+     * @param path 出力パス
+     * @param n_agents 1フレームあたりのエージェント数
+     * @param dt 記録時のタイムステップ [s]
+     * @param frame_count_interval ヘッダのフレーム数を書き戻すフレーム間隔（0: close() でのみ確定）
+     * @throws std::runtime_error ファイルを開けない場合
+     */
+    BasicSpmRecorder(const std::string& path, std::size_t n_agents, double dt,
+                     std::size_t frame_count_interval = 0)
+        : file_(path, std::ios::binary | std::ios::trunc)
+        , n_agents_(n_agents)
+        , dt_(dt)
+        , frame_count_interval_(frame_count_interval)
+    {
+        if (!file_) {
+            throw std::runtime_error("Cannot open SPM recording for writing: " + path);
+        }
+        write_header();
+    }
+
+    BasicSpmRecorder(const BasicSpmRecorder&) = delete;
+    auto operator=(const BasicSpmRecorder&) -> BasicSpmRecorder& = delete;
+
+    ~BasicSpmRecorder() {
+        try {
+            close();
+        } catch (...) {
+            // デストラクタでは例外を投げない（途中フレームは破棄される）
+        }
+    }
+
+    /**
+     * @brief 1エージェント分のチャネルを追記
+     * @param spm SaliencyPolarMap または SpmBatch のビュー
+     */
+    template <typename SpmT>
+    void append_agent(const SpmT& spm) {
+        for (int c = 0; c < Channels; ++c) {
+            const auto ch = spm.channel(static_cast<eph::ChannelID>(c));
+            file_.write(reinterpret_cast<const char*>(ch.data()),
+                        static_cast<std::streamsize>(sizeof(Scalar) * kChannelSize));
+        }
+        if (++agents_in_frame_ == n_agents_) {
+            agents_in_frame_ = 0;
+            ++frames_;
+            if (frame_count_interval_ != 0 && frames_ % frame_count_interval_ == 0) {
+                commit_frame_count();
+            }
+        }
+    }
+
+    // 全エージェント分を1フレームとして追記
+    void append_frame(const Batch& batch) {
+        assert(batch.size() == n_agents_ && agents_in_frame_ == 0);
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            append_agent(batch.agent(i));
+        }
+    }
+
+    /**
+     * @brief ヘッダのフレーム数を確定してファイルを閉じる
+     * @throws std::runtime_error 書き込みに失敗した場合・フレーム途中の場合
+     */
+    void close() {
+        if (!file_.is_open()) {
+            return;
+        }
+        const bool partial = agents_in_frame_ != 0;
+        file_.seekp(0);
+        write_header();
+        file_.close();
+        if (file_.fail()) {
+            throw std::runtime_error("Failed to write SPM recording");
+        }
+        if (partial) {
+            throw std::runtime_error("SPM recording closed in the middle of a frame");
+        }
+    }
+
+    auto frames() const -> std::size_t { return frames_; }
+    auto n_agents() const -> std::size_t { return n_agents_; }
+
+private:
+    std::ofstream file_;
+    std::size_t n_agents_;
+    double dt_;
+    std::size_t frame_count_interval_;
+    std::size_t frames_ = 0;
+    std::size_t agents_in_frame_ = 0;
+
+    // ヘッダのフレーム数だけを書き換えて末尾に戻る
+    // （シークでバッファ済みの内容はOSへ渡るため、明示的な flush() は不要）
+    void commit_frame_count() {
+        const auto end = file_.tellp();
+        const std::uint64_t n_frames = frames_;
+        file_.seekp(static_cast<std::streamoff>(offsetof(SpmRecordingHeader, n_frames)));
+        file_.write(reinterpret_cast<const char*>(&n_frames), sizeof(n_frames));
+        file_.seekp(end);
+    }
+
+    void write_header() {
+        SpmRecordingHeader header{};
+        std::memcpy(header.magic, SpmRecordingHeader::kMagic, sizeof(header.magic));
+        header.version = SpmRecordingHeader::kVersion;
+        header.scalar_bytes = sizeof(Scalar);
+        header.channels = Channels;
+        header.n_theta = NTheta;
+        header.n_r = NR;
+        header.n_agents = n_agents_;
+        header.n_frames = frames_;
+        header.dt = dt_;
+        file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+};
+
+/**
+ * @brief SPM記録ファイルの読み取り（mmap）
+ *
+ * ファイル全体を読み取り専用でメモリマップし、agent(frame, i) で
+ * 該当ブロックをコピーなしの読み取り専用ビュー（SpmBatch::ConstView と同型）として返す。
+ * ビューは HazeEstimator / ActionSelector / EPHAgent::update にそのまま渡せる。
+ *
+ * 注: 記録には時間チャネルの作業列が無いため、再生ビューで previous_occupancy() は使わないこと。
+ * 注: ビューは BasicSpmRecording より長く保持しないこと。
+ */
+template <int Channels, int NTheta, int NR, typename ScalarT = eph::Scalar>
+class BasicSpmRecording {
+public:
+    using Scalar = ScalarT;
+    using ConstView = BasicSpmView<Channels, NTheta, NR, ScalarT, false>;
+
+    static constexpr int kChannelSize = NTheta * NR;
+    static constexpr std::size_t kAgentBytes = sizeof(Scalar) * kChannelSize * Channels;
+
+    /**
+     * @brief 記録ファイルをメモリマップ
+     * @param path 記録ファイル
+     * @throws std::runtime_error 開けない・形式や次元・スカラー型が一致しない場合
+     */
+    explicit BasicSpmRecording(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open SPM recording: " + path);
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(SpmRecordingHeader)) {
+            ::close(fd);
+            throw std::runtime_error("SPM recording is truncated: " + path);
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // マップはファイル記述子を閉じても有効
+        if (mapped == MAP_FAILED) {
+            throw std::runtime_error("Cannot map SPM recording: " + path);
+        }
+        base_ = static_cast<const unsigned char*>(mapped);
+        ::madvise(mapped, size_, MADV_SEQUENTIAL);
+
+        try {
+            validate(path);
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    BasicSpmRecording(const BasicSpmRecording&) = delete;
+    auto operator=(const BasicSpmRecording&) -> BasicSpmRecording& = delete;
+
+    BasicSpmRecording(BasicSpmRecording&& other) noexcept
+        : base_(std::exchange(other.base_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , header_(other.header_) {}
+
+    auto operator=(BasicSpmRecording&& other) noexcept -> BasicSpmRecording& {
+        if (this != &other) {
+            unmap();
+            base_ = std::exchange(other.base_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            header_ = other.header_;
+        }
+        return *this;
+    }
+
+    ~BasicSpmRecording() { unmap(); }
+
+    auto n_agents() const -> std::size_t { return static_cast<std::size_t>(header_.n_agents); }
+    auto n_frames() const -> std::size_t { return static_cast<std::size_t>(header_.n_frames); }
+    auto dt() const -> double { return header_.dt; }
+
+    // フレーム frame のエージェント i（ゼロコピー）
+    auto agent(std::size_t frame, std::size_t i) const -> ConstView {
+        assert(frame < n_frames() && i < n_agents());
+        const std::size_t offset = sizeof(SpmRecordingHeader) + (frame * n_agents() + i) * kAgentBytes;
+        return ConstView(reinterpret_cast<const Scalar*>(base_ + offset));
+    }
+
+private:
+    const unsigned char* base_ = nullptr;
+    std::size_t size_ = 0;
+    SpmRecordingHeader header_{};
+
+    void validate(const std::string& path) {
+        std::memcpy(&header_, base_, sizeof(header_));
+        if (std::memcmp(header_.magic, SpmRecordingHeader::kMagic, sizeof(header_.magic)) != 0 ||
+            header_.version != SpmRecordingHeader::kVersion) {
+            throw std::runtime_error("Not an SPM recording (or unsupported version): " + path);
+        }
+        if (header_.scalar_bytes != sizeof(Scalar) ||
+            header_.channels != static_cast<std::uint32_t>(Channels) ||
+            header_.n_theta != static_cast<std::uint32_t>(NTheta) ||
+            header_.n_r != static_cast<std::uint32_t>(NR)) {
+            throw std::runtime_error("SPM recording dimensions or scalar type do not match: " + path);
+        }
+        // 本体に収まるエージェントブロック数と比較する（n_frames·n_agents の積は
+        // 壊れたヘッダで桁あふれしうるため、掛ける前に除算で確かめる）
+        const std::uint64_t capacity = (size_ - sizeof(SpmRecordingHeader)) / kAgentBytes;
+        if (header_.n_agents != 0 && header_.n_frames > capacity / header_.n_agents) {
+            throw std::runtime_error("SPM recording is truncated: " + path);
+        }
+    }
+
+    void unmap() {
+        if (base_ != nullptr) {
+            ::munmap(const_cast<unsigned char*>(base_), size_);
+            base_ = nullptr;
+        }
+    }
+};
+
+// 標準構成（10チャネル × 12×12）
+using SpmRecorder = BasicSpmRecorder<
+    constants::N_CHANNELS, constants::N_THETA, constants::N_R, eph::Scalar>;
+using SpmRecording = BasicSpmRecording<
+    constants::N_CHANNELS, constants::N_THETA, constants::N_R, eph::Scalar>;
+
+}  // namespace eph::spm
+
+#endif  // EPH_SPM_SPM_RECORDING_HPP
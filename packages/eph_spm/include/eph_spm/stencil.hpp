@@ -0,0 +1,176 @@
+#ifndef EPH_SPM_STENCIL_HPP
+#define EPH_SPM_STENCIL_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include <utility>
+#include "eph_core/types.hpp"
+
+namespace eph::spm::stencil {
+
+/**
+ * @brief 極座標格子のステンシルエンジン
+ *
+ * 列優先の θ×r フィールドに対して、境界条件をテンプレート引数で与えた
+ * 近傍アクセスを提供する。勾配・平滑化・ラプラシアンなどの演算子は
+ * 近傍 at<dθ, dr>() の組み合わせとして書く（gradient_kernel.hpp, HazeEstimator）。
+ *
+ * - 近傍インデックスは境界ポリシーから作るコンパイル時テーブル（内側ループに剰余なし）
+ * - r 列ループは完全展開し、列インデックス b と近傍列はコンパイル時定数
+ * - θ 方向は列ベクトル単位で処理: 折り返さない内部行は連続区間のコピー（SIMD）、
+ *   折り返す境界行のみテーブル参照
+ *
+ * ```cpp
+ * using Grid = stencil::Polar<stencil::Periodic, stencil::Reflect>;
+ * Grid::for_each_column<NT>(field, [&](const auto& col) {
+ *     constexpr int b = std::decay_t<decltype(col)>::kColumn;
+ *     out.col(b) = (col.template at<1, 0>() - col.template at<-1, 0>()).matrix();
+ * });
+ * ```
+ */
+
+// === 境界ポリシー ===
+
+// 周期境界（θ方向: a=0 と a=N-1 が隣接）
+struct Periodic {
+    static constexpr auto index(int i, int n) -> int {
+        const int r = i % n;
+        return r < 0 ? r + n : r;
+    }
+};
+
+// Neumann境界（端セル中心で鏡映: -1 → 1, N → N-2）。端での中心差分がゼロになる
+struct Reflect {
+    static constexpr auto index(int i, int n) -> int {
+        if (n == 1) {
+            return 0;
+        }
+        return i < 0 ? -i : (i >= n ? 2 * (n - 1) - i : i);
+    }
+};
+
+// Neumann境界（端セルを複製: -1 → 0, N → N-1）。境界面を通る流束がゼロになる
+struct Clamp {
+    static constexpr auto index(int i, int n) -> int {
+        return std::clamp(i, 0, n - 1);
+    }
+};
+
+/**
+ * @brief 近傍インデックステーブル（コンパイル時）
+ *
+ * kIndex[i] = Policy::index(i + Offset, N)
+ */
+template <typename Policy, int N, int Offset>
+struct NeighborTable {
+    static constexpr auto make() -> std::array<int, N> {
+        std::array<int, N> table{};
+        for (int i = 0; i < N; ++i) {
+            table[i] = Policy::index(i + Offset, N);
+        }
+        return table;
+    }
+
+    static constexpr std::array<int, N> kIndex = make();
+};
+
+/**
+ * @brief θ境界・r境界を指定した極座標ステンシル
+ *
+ * @tparam ThetaPolicy θ方向の境界ポリシー
+ * @tparam RPolicy r方向の境界ポリシー
+ */
+template <typename ThetaPolicy, typename RPolicy>
+struct Polar {
+    /**
+     * @brief r 列 b の近傍ビュー（出力行 [0, Rows)）
+     *
+     * Rows < N_θ のとき先頭 Rows 行（視野内）のみ計算する。近傍としては全行を読む。
+     */
+    template <typename Derived, int Rows, int b>
+    class Column {
+    public:
+        using Scalar = typename Derived::Scalar;
+        using Values = Eigen::Array<Scalar, Rows, 1>;
+
+        static constexpr int kColumn = b;
+        static constexpr int kNTheta = Derived::RowsAtCompileTime;
+        static constexpr int kNR = Derived::ColsAtCompileTime;
+
+        explicit Column(const Eigen::MatrixBase<Derived>& field) : field_(field) {}
+
+        // r 方向の近傍列（コンパイル時）
+        template <int DR>
+        static constexpr int kNeighborColumn = NeighborTable<RPolicy, kNR, DR>::kIndex[b];
+
+        // ±DR の近傍列が一致する（境界で鏡映された）とき、その方向の中心差分はゼロ
+        template <int DR>
+        static constexpr bool kSymmetricR = kNeighborColumn<DR> == kNeighborColumn<-DR>;
+
+        /**
+         * @brief 近傍値 field(θ(a + DA), r(b + DR))、a ∈ [0, Rows)
+         */
+        template <int DA, int DR>
+        auto at() const -> Values {
+            const auto c = field_.col(kNeighborColumn<DR>);
+            constexpr auto& table = NeighborTable<ThetaPolicy, kNTheta, DA>::kIndex;
+
+            // 折り返さない行 [lo, hi) は連続区間 [lo + DA, hi + DA)
+            constexpr int lo = std::min(DA < 0 ? -DA : 0, Rows);
+            constexpr int hi = std::max(lo, std::min(Rows, kNTheta - (DA > 0 ? DA : 0)));
+
+            Values v;
+            for (int a = 0; a < lo; ++a) {
+                v(a) = c(table[a]);
+            }
+            if constexpr (hi > lo) {
+                v.template segment<hi - lo>(lo) = c.template segment<hi - lo>(lo + DA).array();
+            }
+            for (int a = hi; a < Rows; ++a) {
+                v(a) = c(table[a]);
+            }
+            return v;
+        }
+
+    private:
+        const Eigen::MatrixBase<Derived>& field_;
+    };
+
+    /**
+     * @brief 全 r 列に列演算を適用（r 列ループは完全展開）
+     *
+     * @tparam Rows 出力行数（視野内行数、全行なら N_θ）
+     * @param field 入力フィールド（θ×r、固定長）
+     * @param op op(const Column<...>&) を r 列ごとに呼ぶ
+     */
+    template <int Rows, typename Derived, typename ColumnOp>
+    static EIGEN_STRONG_INLINE void for_each_column(const Eigen::MatrixBase<Derived>& field, ColumnOp&& op) {
+        constexpr int NT = Derived::RowsAtCompileTime;
+        constexpr int NR = Derived::ColsAtCompileTime;
+        static_assert(NT != Eigen::Dynamic && NR != Eigen::Dynamic, "Polar grid must have fixed size");
+        static_assert(Rows >= 1 && Rows <= NT, "Output rows out of range");
+        for_each_column_impl<Rows>(field, op, std::make_integer_sequence<int, NR>{});
+    }
+
+private:
+    template <int Rows, typename Derived, typename ColumnOp, int... Bs>
+    static EIGEN_STRONG_INLINE void for_each_column_impl(
+        const Eigen::MatrixBase<Derived>& field,
+        ColumnOp& op,
+        std::integer_sequence<int, Bs...>
+    ) {
+        (op(Column<Derived, Rows, Bs>(field)), ...);
+    }
+};
+
+// 極座標SPMの標準境界: θ周期・r Neumann（微分演算子用、端で中心差分ゼロ）
+using PolarDerivative = Polar<Periodic, Reflect>;
+
+// 極座標SPMの標準境界: θ周期・r Neumann（平滑化用、端セル複製）
+using PolarSmoothing = Polar<Periodic, Clamp>;
+
+}  // namespace eph::spm::stencil
+
+#endif  // EPH_SPM_STENCIL_HPP
@@ -0,0 +1,94 @@
+#ifndef EPH_SPM_TEMPORAL_CHANNELS_HPP
+#define EPH_SPM_TEMPORAL_CHANNELS_HPP
+
+#include <Eigen/Core>
+#include "eph_core/types.hpp"
+#include "eph_core/constants.hpp"
+
+namespace eph::spm::temporal {
+
+/**
+ * @brief 時間チャネル（R0: Δ占有, F5: 観測安定性）用の追加ストレージ配置
+ *
+ * 占有 F0 は2面のバッファ（表/裏）を持ち、フレーム開始時に表裏を入れ替える。
+ * 入れ替えはバッファ番号の反転のみで、テンソルのコピーは行わない。
+ * F5 の算出に使う占有の指数移動平均も1面保持する。
+ *
+ * チャネル列の後ろに追加列として配置する:
+ * - kBackColumn: 占有の裏バッファ（前フレーム）
+ * - kMeanColumn: 占有の指数移動平均
+ *
+ * F5 を持たない縮小構成（Channels ≤ F5）では追加列なし・時間チャネルなし。
+ */
+template <int Channels>
+struct Layout {
+    static constexpr int kOccupancy = static_cast<int>(ChannelID::F0);
+    static constexpr int kDelta = static_cast<int>(ChannelID::R0);
+    static constexpr int kStability = static_cast<int>(ChannelID::F5);
+
+    static constexpr bool kEnabled = Channels > kStability;
+    static constexpr int kBackColumn = Channels;
+    static constexpr int kMeanColumn = Channels + 1;
+    static constexpr int kColumns = kEnabled ? Channels + 2 : Channels;
+
+    // チャネル c の格納列（swapped: 占有の表裏が入れ替わっている状態）
+    static constexpr auto column(int c, bool swapped) -> int {
+        return (kEnabled && swapped && c == kOccupancy) ? kBackColumn : c;
+    }
+
+    // 前フレーム占有の格納列
+    static constexpr auto previous_occupancy_column(bool swapped) -> int {
+        return swapped ? kOccupancy : kBackColumn;
+    }
+};
+
+/**
+ * @brief R0・F5 の増分更新（1チャネル分、ベクトル化）
+ *
+ * - R0 = clip(O[k] − O[k−1], −1, 1)（appendix B: ΔO の真値）
+ * - F5 = 2·σ[k]（占有 ∈ [0,1] の標準偏差は ≤ 0.5 なので [0,1] に正規化）
+ *
+ * σ は長さ w = F5_STABILITY_WINDOW の矩形窓を α = 2/(w+1) の指数窓で近似する:
+ *   d = O[k] − μ[k−1]
+ *   μ[k]  = μ[k−1] + α·d
+ *   σ²[k] = (1−α)·(σ²[k−1] + α·d²)
+ * σ²[k−1] は前フレームの F5 から復元するため、過去 w フレームの履歴は不要。
+ *
+ * @param occupancy 現フレーム占有 O[k]
+ * @param previous 前フレーム占有 O[k−1]
+ * @param mean 占有の指数移動平均 μ（入出力）
+ * @param delta R0（出力）
+ * @param stability F5（入出力）
+ */
+template <int Size, typename ScalarT>
+inline void update(
+    const ScalarT* occupancy,
+    const ScalarT* previous,
+    ScalarT* mean,
+    ScalarT* delta,
+    ScalarT* stability
+) {
+    using Array = Eigen::Array<ScalarT, Size, 1>;
+    using ConstMap = Eigen::Map<const Array>;
+    using MutMap = Eigen::Map<Array>;
+
+    constexpr ScalarT kAlpha = static_cast<ScalarT>(2.0 / (constants::F5_STABILITY_WINDOW + 1));
+
+    const ConstMap o(occupancy);
+    const ConstMap p(previous);
+    MutMap mu(mean);
+    MutMap r0(delta);
+    MutMap f5(stability);
+
+    r0 = (o - p).cwiseMax(ScalarT(-1.0)).cwiseMin(ScalarT(1.0));
+
+    const Array d = o - mu;
+    const Array var_prev = (f5 * ScalarT(0.5)).square();
+    const Array var = (ScalarT(1.0) - kAlpha) * (var_prev + kAlpha * d.square());
+    mu += kAlpha * d;
+    f5 = (ScalarT(2.0) * var.sqrt()).cwiseMin(ScalarT(1.0));
+}
+
+}  // namespace eph::spm::temporal
+
+#endif  // EPH_SPM_TEMPORAL_CHANNELS_HPP
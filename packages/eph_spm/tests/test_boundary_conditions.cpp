@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <cmath>
+#include <limits>
 #include "eph_spm/saliency_polar_map.hpp"
 
 using namespace eph;
@@ -53,7 +54,7 @@ TEST(BoundaryConditions, GradientTheta_SinWave_MatchesTheory) {
             double f_minus = std::sin(2.0 * PI * (a - 1) / 12.0);
             double expected = (f_plus - f_minus) / (2.0 * DELTA_THETA);
 
-            EXPECT_NEAR(grad(a, b), expected, 1e-10)
+            EXPECT_NEAR(grad(a, b), expected, 8 * std::numeric_limits<Scalar>::epsilon())
                 << "Gradient mismatch at (θ=" << a << ", r=" << b << ")";
         }
     }
@@ -147,3 +148,75 @@ TEST(BoundaryConditions, GradientMagnitude_PositiveValues) {
         }
     }
 }
+
+// === 融合勾配カーネル ===
+
+TEST(BoundaryConditions, FusedGradient_MatchesSeparateOperators) {
+    SaliencyPolarMap spm;
+    Matrix12x12 test_channel = Matrix12x12::Random();
+    spm.set_channel(ChannelID::F2, test_channel);
+
+    auto fused = spm.gradient(ChannelID::F2);
+    auto grad_theta = spm.gradient_theta(ChannelID::F2);
+    auto grad_r = spm.gradient_r(ChannelID::F2);
+
+    // 視野内ビンは参照演算子（全ビン）とビット単位で一致（同じ差分・除算、|∇| は
+    // Scalar の sqrt。配列の sqrt も正しく丸める: EIGEN_FAST_MATH=0）、死角ビンは計算しない（0）
+    constexpr int kVisible = FovMask<12>::kVisible;
+    for (int a = 0; a < 12; ++a) {
+        for (int b = 0; b < 12; ++b) {
+            if (a >= kVisible) {
+                EXPECT_EQ(fused.magnitude(a, b), 0.0);
+                EXPECT_EQ(fused.theta(a, b), 0.0);
+                EXPECT_EQ(fused.r(a, b), 0.0);
+                continue;
+            }
+            const Scalar expected_mag = std::sqrt(grad_theta(a, b) * grad_theta(a, b) +
+                                                  grad_r(a, b) * grad_r(a, b));
+            EXPECT_EQ(fused.theta(a, b), grad_theta(a, b))
+                << "θ gradient mismatch at (θ=" << a << ", r=" << b << ")";
+            EXPECT_EQ(fused.r(a, b), grad_r(a, b))
+                << "r gradient mismatch at (θ=" << a << ", r=" << b << ")";
+            EXPECT_EQ(fused.magnitude(a, b), expected_mag)
+                << "Magnitude mismatch at (θ=" << a << ", r=" << b << ")";
+        }
+    }
+
+    EXPECT_EQ(spm.gradient_magnitude(ChannelID::F2), fused.magnitude);
+}
+
+TEST(BoundaryConditions, FusedGradient_NeumannEdgesUseThetaOnly) {
+    SaliencyPolarMap spm;
+
+    // r方向のみに変化するフィールド → 端（b=0, 11）で|∇|=0
+    Matrix12x12 test_channel;
+    for (int a = 0; a < 12; ++a) {
+        for (int b = 0; b < 12; ++b) {
+            test_channel(a, b) = static_cast<double>(b * b);
+        }
+    }
+    spm.set_channel(ChannelID::F2, test_channel);
+
+    auto mag = spm.gradient_magnitude(ChannelID::F2);
+    for (int a = 0; a < FovMask<12>::kVisible; ++a) {
+        EXPECT_DOUBLE_EQ(mag(a, 0), 0.0);
+        EXPECT_DOUBLE_EQ(mag(a, 11), 0.0);
+        EXPECT_NEAR(mag(a, 5), 10.0, 1e-12);  // (36 - 16) / 2
+    }
+}
+
+TEST(BoundaryConditions, GradientMagnitudeAll_MatchesPerChannel) {
+    SaliencyPolarMap spm;
+    for (int ch = 0; ch < 10; ++ch) {
+        spm.set_channel(static_cast<ChannelID>(ch), Matrix12x12::Random());
+    }
+
+    SaliencyPolarMap::ChannelArray all;
+    spm.gradient_magnitude_all(all);
+
+    for (int ch = 0; ch < 10; ++ch) {
+        auto expected = spm.gradient_magnitude(static_cast<ChannelID>(ch));
+        EXPECT_TRUE(all[ch].isApprox(expected, 1e-12))
+            << "Batch gradient mismatch for channel " << ch;
+    }
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <array>
+#include "eph_spm/lazy_spm.hpp"
+
+using namespace eph;
+using namespace eph::spm;
+
+namespace {
+
+// チャネルごとの生成回数を数える生成関数（値はチャネル番号 + フレーム番号）
+struct CountingProducer {
+    std::array<int, constants::N_CHANNELS>* calls;
+    const int* frame;
+
+    void operator()(ChannelID id, SaliencyPolarMap& map) const {
+        ++(*calls)[static_cast<int>(id)];
+        Matrix12x12 field = Matrix12x12::Zero();
+        field(static_cast<int>(id), *frame % 12) = 1.0;
+        map.set_channel(id, field);
+    }
+};
+
+}  // namespace
+
+TEST(ChannelSet, MaskAndDependencies) {
+    constexpr ChannelMask kRead = kChannelMask<ChannelID::F2, ChannelID::F5>;
+    static_assert(contains(kRead, ChannelID::F2));
+    static_assert(!contains(kRead, ChannelID::F0));
+    static_assert(with_dependencies(kRead) == (kRead | channel_bit(ChannelID::F0)));
+    static_assert(with_dependencies(kChannelMask<ChannelID::F1>) == kChannelMask<ChannelID::F1>);
+    static_assert(kAllChannels == 0x3FF);
+}
+
+TEST(LazySpm, ProducesOnlyReadChannelsOncePerFrame) {
+    std::array<int, constants::N_CHANNELS> calls{};
+    int frame = 0;
+    auto spm = make_lazy_spm<kChannelMask<ChannelID::F2, ChannelID::F4>>(CountingProducer{&calls, &frame});
+
+    EXPECT_EQ(spm.evaluated(), kNoChannels);
+    EXPECT_DOUBLE_EQ(spm.channel(ChannelID::F2)(5, 0), 1.0);
+    spm.gradient_magnitude_mean(ChannelID::F2);
+    spm.channel_mean(ChannelID::F2);
+
+    EXPECT_EQ(calls[static_cast<int>(ChannelID::F2)], 1);
+    EXPECT_EQ(calls[static_cast<int>(ChannelID::F4)], 0);  // 読まれていない
+    EXPECT_EQ(spm.evaluated(), kChannelMask<ChannelID::F2>);
+
+    frame = 1;
+    spm.begin_frame();
+    EXPECT_EQ(spm.evaluated(), kNoChannels);
+    EXPECT_DOUBLE_EQ(spm.channel(ChannelID::F2)(5, 1), 1.0);
+    EXPECT_EQ(calls[static_cast<int>(ChannelID::F2)], 2);
+}
+
+TEST(LazySpm, TemporalChannelsFollowOccupancy) {
+    // F0 の生成関数: 毎フレーム (0, 0) は占有、(1, 0) は点滅
+    int frame = 0;
+    int occupancy_calls = 0;
+    auto producer = [&](ChannelID id, SaliencyPolarMap& map) {
+        ASSERT_EQ(id, ChannelID::F0);
+        ++occupancy_calls;
+        Matrix12x12 occ = Matrix12x12::Zero();
+        occ(0, 0) = 1.0;
+        occ(1, 0) = (frame % 2 == 0) ? 1.0 : 0.0;
+        map.set_channel(id, occ);
+    };
+    auto lazy = make_lazy_spm<kChannelMask<ChannelID::F5>>(producer);
+
+    SaliencyPolarMap eager;
+    for (frame = 0; frame < 10; ++frame) {
+        lazy.begin_frame();
+        const auto f5 = lazy.channel(ChannelID::F5);
+
+        eager.begin_frame();
+        Matrix12x12 occ = Matrix12x12::Zero();
+        occ(0, 0) = 1.0;
+        occ(1, 0) = (frame % 2 == 0) ? 1.0 : 0.0;
+        eager.set_channel(ChannelID::F0, occ);
+        eager.update_temporal();
+
+        EXPECT_EQ(Matrix12x12(f5), eager.get_channel(ChannelID::F5)) << "frame " << frame;
+    }
+    EXPECT_EQ(occupancy_calls, 10);
+    EXPECT_EQ(lazy.evaluated(), (kChannelMask<ChannelID::F0, ChannelID::R0, ChannelID::F5>));
+}
@@ -1,9 +1,18 @@
 #include <gtest/gtest.h>
+#include <limits>
+#include <type_traits>
 #include "eph_spm/saliency_polar_map.hpp"
 
 using namespace eph;
 using namespace eph::spm;
 
+namespace {
+
+// 丸め誤差の許容（Scalar の機械イプシロン基準。倍精度・単精度の両構成で実行）
+constexpr Scalar kEps = std::numeric_limits<Scalar>::epsilon();
+
+}  // namespace
+
 // === 基本機能テスト ===
 
 TEST(SaliencyPolarMap, Constructor_InitializesToZero) {
@@ -102,3 +111,411 @@ TEST(SaliencyPolarMap, AllChannelIDs_Accessible) {
             << "Channel access failed for ChannelID " << static_cast<int>(id);
     }
 }
+
+// === ゼロコピービューテスト ===
+
+TEST(SaliencyPolarMap, ChannelView_MatchesGetChannel) {
+    SaliencyPolarMap spm;
+    Matrix12x12 test_data = Matrix12x12::Random();
+    spm.set_channel(ChannelID::F2, test_data);
+
+    auto view = spm.channel(ChannelID::F2);
+    EXPECT_TRUE(Matrix12x12(view).isApprox(test_data, 1e-10));
+}
+
+TEST(SaliencyPolarMap, MutableChannelView_WritesThrough) {
+    SaliencyPolarMap spm;
+
+    auto view = spm.mutable_channel(ChannelID::R1);
+    view(3, 7) = 0.25;
+    view.col(0).setConstant(1.0);
+
+    auto retrieved = spm.get_channel(ChannelID::R1);
+    EXPECT_DOUBLE_EQ(retrieved(3, 7), 0.25);
+    EXPECT_DOUBLE_EQ(retrieved(11, 0), 1.0);
+
+    // 他チャネルには影響しない
+    EXPECT_DOUBLE_EQ(spm.get_channel(ChannelID::R0).norm(), 0.0);
+    EXPECT_DOUBLE_EQ(spm.get_channel(ChannelID::F0).norm(), 0.0);
+}
+
+TEST(SaliencyPolarMap, ChannelViews_AreContiguousPerChannel) {
+    SaliencyPolarMap spm;
+
+    // 各チャネルは 144 要素の連続領域で、チャネル順に並ぶ
+    for (int ch = 0; ch + 1 < 10; ++ch) {
+        auto v0 = spm.channel(static_cast<ChannelID>(ch));
+        auto v1 = spm.channel(static_cast<ChannelID>(ch + 1));
+        EXPECT_EQ(v1.data() - v0.data(), 144);
+        EXPECT_EQ(v0.innerStride(), 1);
+        EXPECT_EQ(v0.outerStride(), 12);
+    }
+}
+
+// === 版番号・派生量キャッシュテスト ===
+
+TEST(SaliencyPolarMap, ChannelVersion_BumpedOnWrite) {
+    SaliencyPolarMap spm;
+
+    auto v0 = spm.channel_version(ChannelID::F2);
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    auto v1 = spm.channel_version(ChannelID::F2);
+    EXPECT_GT(v1, v0);
+
+    // 他チャネルの版は変わらない
+    EXPECT_EQ(spm.channel_version(ChannelID::F3), v0);
+
+    spm.mutable_channel(ChannelID::F2)(0, 0) = 1.0;
+    EXPECT_GT(spm.channel_version(ChannelID::F2), v1);
+
+    auto v_f3 = spm.channel_version(ChannelID::F3);
+    spm.zero_all();
+    EXPECT_GT(spm.channel_version(ChannelID::F3), v_f3);
+}
+
+TEST(SaliencyPolarMap, DerivedQuantities_FixedAtWriteTime) {
+    SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+
+    Matrix12x12 before = spm.gradient_magnitude(ChannelID::F2);
+    EXPECT_DOUBLE_EQ(spm.gradient_magnitude_mean(ChannelID::F2), visible_mean(before));
+
+    // 書き込み後は再計算される
+    Matrix12x12 updated = Matrix12x12::Random();
+    spm.set_channel(ChannelID::F2, updated);
+    SaliencyPolarMap reference;
+    reference.set_channel(ChannelID::F2, updated);
+
+    auto expected = reference.gradient(ChannelID::F2).magnitude;
+    EXPECT_TRUE(spm.gradient_magnitude(ChannelID::F2).isApprox(expected, 1e-12));
+    EXPECT_FALSE(spm.gradient_magnitude(ChannelID::F2).isApprox(before, 1e-6));
+    EXPECT_DOUBLE_EQ(spm.gradient_magnitude_mean(ChannelID::F2), visible_mean(expected));
+}
+
+TEST(SaliencyPolarMap, ChannelMean_TracksMutableView) {
+    SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::R1, Matrix12x12::Constant(0.5));
+    EXPECT_DOUBLE_EQ(spm.channel_mean(ChannelID::R1), 0.5);
+
+    // 確定前は読み出しのたびに計算、warm_cache() 後は同じ値を保持値から返す
+    spm.mutable_channel(ChannelID::R1).setConstant(0.25);
+    EXPECT_DOUBLE_EQ(spm.channel_mean(ChannelID::R1), 0.25);
+    spm.warm_cache();
+    EXPECT_DOUBLE_EQ(spm.channel_mean(ChannelID::R1), 0.25);
+
+    spm.zero_all();
+    EXPECT_DOUBLE_EQ(spm.channel_mean(ChannelID::R1), 0.0);
+}
+
+TEST(SaliencyPolarMap, DerivedQuantities_StoredAsScalarsOnly) {
+    // 勾配フィールド・ピラミッド段はマップに持たない（ストレージ + 1チャネル分未満）
+    using Temporal = SaliencyPolarMap::Temporal;
+    static_assert(sizeof(SaliencyPolarMap) < sizeof(Scalar) * 144 * (Temporal::kColumns + 1));
+
+    SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    spm.mutable_channel(ChannelID::F3) = Matrix12x12::Random();
+
+    // 未確定チャネルは const 読み出しで計算し、確定後も同じ値
+    const SaliencyPolarMap& view = spm;
+    const Scalar f2 = view.gradient_magnitude_mean(ChannelID::F2, 1);
+    const Scalar f3 = view.gradient_magnitude_mean(ChannelID::F3, 1);
+    const Scalar f3_mean = view.channel_mean(ChannelID::F3);
+    spm.warm_cache();
+    EXPECT_EQ(spm.gradient_magnitude_mean(ChannelID::F2, 1), f2);
+    EXPECT_EQ(spm.gradient_magnitude_mean(ChannelID::F3, 1), f3);
+    EXPECT_EQ(spm.channel_mean(ChannelID::F3), f3_mean);
+}
+
+// === 一様チャネル ===
+
+TEST(SaliencyPolarMap, UniformFlags_TrackWrites) {
+    SaliencyPolarMap spm;
+    EXPECT_TRUE(spm.is_zero_channel(ChannelID::F2));  // 初期状態は全チャネルゼロ
+
+    spm.set_channel(ChannelID::F2, Matrix12x12::Constant(0.5));
+    ASSERT_TRUE(spm.uniform_value(ChannelID::F2).has_value());
+    EXPECT_DOUBLE_EQ(*spm.uniform_value(ChannelID::F2), 0.5);
+    EXPECT_FALSE(spm.is_zero_channel(ChannelID::F2));
+
+    Matrix12x12 data = Matrix12x12::Constant(0.5);
+    data(3, 7) = 0.25;
+    spm.set_channel(ChannelID::F2, data);
+    EXPECT_FALSE(spm.uniform_value(ChannelID::F2).has_value());
+
+    spm.fill_channel(ChannelID::F2, -1.0);
+    EXPECT_DOUBLE_EQ(*spm.uniform_value(ChannelID::F2), -1.0);
+    EXPECT_TRUE(spm.channel(ChannelID::F2).isApproxToConstant(-1.0));
+
+    // 書き込みビューは内容が分からないのでフラグを落とす
+    spm.mutable_channel(ChannelID::F2).setConstant(2.0);
+    EXPECT_FALSE(spm.uniform_value(ChannelID::F2).has_value());
+
+    spm.zero_all();
+    EXPECT_TRUE(spm.is_zero_channel(ChannelID::F2));
+}
+
+TEST(SaliencyPolarMap, UniformChannel_DerivedQuantitiesMatchGeneralPath) {
+    SaliencyPolarMap spm;
+    spm.fill_channel(ChannelID::F2, 0.7);
+
+    Matrix12x12 constant = Matrix12x12::Constant(0.7);
+    Matrix12x12 expected_mag;
+    kernel::gradient_magnitude(constant, expected_mag);
+
+    EXPECT_EQ(spm.gradient_theta(ChannelID::F2), Matrix12x12::Zero());
+    EXPECT_EQ(spm.gradient_r(ChannelID::F2), Matrix12x12::Zero());
+    EXPECT_EQ(spm.gradient_magnitude(ChannelID::F2), expected_mag);
+    EXPECT_EQ(spm.gradient(ChannelID::F2).magnitude, expected_mag);
+    EXPECT_DOUBLE_EQ(spm.gradient_magnitude_mean(ChannelID::F2), 0.0);
+    EXPECT_DOUBLE_EQ(spm.channel_mean(ChannelID::F2), Scalar(0.7));
+}
+
+TEST(SaliencyPolarMap, UniformFlags_FollowOccupancySwap) {
+    SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F0, Matrix12x12::Random());
+    EXPECT_FALSE(spm.uniform_value(ChannelID::F0).has_value());
+
+    // 表裏入れ替え後の F0 は2フレーム前（初期値ゼロ）のバッファ
+    spm.begin_frame();
+    EXPECT_TRUE(spm.is_zero_channel(ChannelID::F0));
+
+    spm.update_temporal();
+    EXPECT_FALSE(spm.uniform_value(ChannelID::R0).has_value());
+    EXPECT_FALSE(spm.uniform_value(ChannelID::F5).has_value());
+
+    spm.begin_frame();
+    EXPECT_FALSE(spm.uniform_value(ChannelID::F0).has_value());
+}
+
+// === 視野マスク ===
+
+TEST(SaliencyPolarMap, FovMask_DerivedFromFieldOfView) {
+    // 270° FOV / 12 θビン → 視野内 9 行、死角 3 行
+    static_assert(FovMask<12>::kVisible == 9);
+    static_assert(!FovMask<12>::kFull);
+    static_assert(FovMask<12>::visible(8) && !FovMask<12>::visible(9));
+    static_assert(FovMask<24>::kVisible == 18);
+}
+
+TEST(SaliencyPolarMap, ChannelMean_IgnoresBlindSpot) {
+    SaliencyPolarMap spm;
+    Matrix12x12 data = Matrix12x12::Constant(0.5);
+    data.bottomRows<3>().setConstant(100.0);  // 死角ビンの値は縮約に寄与しない
+    spm.set_channel(ChannelID::R1, data);
+
+    EXPECT_DOUBLE_EQ(spm.channel_mean(ChannelID::R1), 0.5);
+    EXPECT_DOUBLE_EQ(visible_mean(data), 0.5);
+}
+
+TEST(SaliencyPolarMap, FusedGradient_VisibleEdgeReadsPeriodicNeighbors) {
+    // 視野端（a = 0, 8）の θ 勾配は死角ビンを周期近傍として読む
+    SaliencyPolarMap spm;
+    Matrix12x12 data = Matrix12x12::Zero();
+    data.row(11).setConstant(2.0);  // a = 0 の下側近傍
+    data.row(9).setConstant(4.0);   // a = 8 の上側近傍
+    spm.set_channel(ChannelID::F2, data);
+
+    const Scalar two_dtheta = 2.0 * (2.0 * constants::PI / 12.0);
+    auto fused = spm.gradient(ChannelID::F2);
+    EXPECT_NEAR(fused.theta(0, 3), -2.0 / two_dtheta, 8 * kEps);
+    EXPECT_NEAR(fused.theta(8, 3), 4.0 / two_dtheta, 8 * kEps);
+    EXPECT_DOUBLE_EQ(fused.magnitude.bottomRows<3>().norm(), 0.0);
+}
+
+// === コンパイル時次元テスト ===
+
+TEST(SaliencyPolarMap, DefaultMap_IsAliasOfTemplate) {
+    static_assert(std::is_same_v<SaliencyPolarMap,
+                                 BasicSaliencyPolarMap<10, 12, 12, eph::Scalar>>);
+    static_assert(SaliencyPolarMap::channel_count() == 10);
+    static_assert(SaliencyPolarMap::kChannelSize == 144);
+    SUCCEED();
+}
+
+TEST(SaliencyPolarMap, HighResolutionMap_DimensionsAndRoundTrip) {
+    using HighResMap = BasicSaliencyPolarMap<10, 24, 16>;
+    HighResMap spm;
+
+    EXPECT_EQ(spm.channel_count(), 10);
+    EXPECT_EQ(spm.theta_count(), 24);
+    EXPECT_EQ(spm.r_count(), 16);
+
+    HighResMap::ChannelMatrix data = HighResMap::ChannelMatrix::Random();
+    spm.set_channel(ChannelID::F2, data);
+    EXPECT_TRUE(spm.get_channel(ChannelID::F2).isApprox(data, 1e-10));
+    EXPECT_DOUBLE_EQ(spm.get_channel(ChannelID::F1).norm(), 0.0);
+}
+
+TEST(SaliencyPolarMap, CoarseMap_FusedGradientMatchesReference) {
+    using CoarseMap = BasicSaliencyPolarMap<4, 6, 6>;
+    CoarseMap spm;
+    spm.set_channel(ChannelID::R1, CoarseMap::ChannelMatrix::Random());
+
+    auto grad_theta = spm.gradient_theta(ChannelID::R1);
+    auto grad_r = spm.gradient_r(ChannelID::R1);
+    auto expected = (grad_theta.array().square() + grad_r.array().square()).sqrt().matrix();
+
+    // 6 θビン・270° FOV → 視野内 5 行（4.5 ビンを切り上げ）
+    constexpr int kVisible = FovMask<6>::kVisible;
+    static_assert(kVisible == 5);
+
+    auto mag = spm.gradient_magnitude(ChannelID::R1);
+    EXPECT_TRUE(mag.topRows<kVisible>().isApprox(expected.topRows<kVisible>(), 1e-12));
+    EXPECT_DOUBLE_EQ(mag.bottomRows<1>().norm(), 0.0);
+
+    auto fused = spm.gradient(ChannelID::R1);
+    EXPECT_TRUE(fused.theta.topRows<kVisible>().isApprox(grad_theta.topRows<kVisible>(), 1e-12));
+    EXPECT_TRUE(fused.r.topRows<kVisible>().isApprox(grad_r.topRows<kVisible>(), 1e-12));
+}
+
+TEST(SaliencyPolarMap, SinglePrecisionMap_GradientMatchesReference) {
+    using FloatMap = BasicSaliencyPolarMap<10, 12, 12, float>;
+    FloatMap spm;
+    spm.set_channel(ChannelID::F2, FloatMap::ChannelMatrix::Random());
+
+    auto grad_theta = spm.gradient_theta(ChannelID::F2);
+    auto grad_r = spm.gradient_r(ChannelID::F2);
+    auto expected = (grad_theta.array().square() + grad_r.array().square()).sqrt().matrix();
+
+    constexpr int kVisible = FovMask<12>::kVisible;
+    EXPECT_TRUE(spm.gradient_magnitude(ChannelID::F2).topRows<kVisible>()
+                    .isApprox(expected.topRows<kVisible>(), 1e-5f));
+}
+
+// === 時間チャネル（R0, F5） ===
+
+TEST(SaliencyPolarMap, BeginFrame_SwapsOccupancyWithoutCopy) {
+    SaliencyPolarMap spm;
+    Matrix12x12 prev = Matrix12x12::Constant(0.25);
+    spm.set_channel(ChannelID::F0, prev);
+    const Scalar* front = spm.channel(ChannelID::F0).data();
+
+    spm.begin_frame();
+
+    // 前フレームの占有は元のバッファのまま参照できる
+    EXPECT_EQ(spm.previous_occupancy().data(), front);
+    EXPECT_NE(spm.channel(ChannelID::F0).data(), front);
+    EXPECT_EQ(spm.previous_occupancy(), prev);
+
+    // もう一度入れ替えると元の表に戻る
+    spm.begin_frame();
+    EXPECT_EQ(spm.channel(ChannelID::F0).data(), front);
+}
+
+TEST(SaliencyPolarMap, UpdateTemporal_DeltaOccupancyIsClippedDifference) {
+    SaliencyPolarMap spm;
+    Matrix12x12 prev = Matrix12x12::Zero();
+    prev(4, 2) = 1.0;
+    prev(5, 5) = 0.5;
+    spm.set_channel(ChannelID::F0, prev);
+
+    spm.begin_frame();
+    Matrix12x12 cur = Matrix12x12::Zero();
+    cur(5, 5) = 1.0;
+    cur(6, 6) = 1.0;
+    spm.set_channel(ChannelID::F0, cur);
+
+    const auto r0_version = spm.channel_version(ChannelID::R0);
+    spm.update_temporal();
+
+    const auto r0 = spm.channel(ChannelID::R0);
+    EXPECT_DOUBLE_EQ(r0(4, 2), -1.0);  // 消失
+    EXPECT_DOUBLE_EQ(r0(5, 5), 0.5);
+    EXPECT_DOUBLE_EQ(r0(6, 6), 1.0);   // 出現
+    EXPECT_DOUBLE_EQ(r0(0, 0), 0.0);
+    EXPECT_NE(spm.channel_version(ChannelID::R0), r0_version);
+}
+
+TEST(SaliencyPolarMap, UpdateTemporal_StabilityTracksFlicker) {
+    SaliencyPolarMap spm;
+
+    // (0,0): 常に占有、(1,0): 毎フレーム点滅、その他: 常に空
+    for (int k = 0; k < 40; ++k) {
+        spm.begin_frame();
+        Matrix12x12 occ = Matrix12x12::Zero();
+        occ(0, 0) = 1.0;
+        occ(1, 0) = (k % 2 == 0) ? 1.0 : 0.0;
+        spm.set_channel(ChannelID::F0, occ);
+        spm.update_temporal();
+    }
+
+    const auto f5 = spm.channel(ChannelID::F5);
+    EXPECT_LT(f5(0, 0), 1e-3);   // 一定の占有は安定
+    EXPECT_GT(f5(1, 0), 0.5);    // 点滅は不安定
+    EXPECT_LE(f5(1, 0), 1.0);
+    EXPECT_DOUBLE_EQ(f5(2, 0), 0.0);
+}
+
+TEST(SaliencyPolarMap, TemporalChannels_OnlyForFullChannelLayout) {
+    static_assert(SaliencyPolarMap::has_temporal_channels());
+    static_assert(BasicSaliencyPolarMap<constants::N_CHANNELS, 24, 16>::has_temporal_channels());
+    static_assert(!BasicSaliencyPolarMap<4, 6, 6>::has_temporal_channels());
+}
+
+// === 多重解像度ピラミッド ===
+
+TEST(SaliencyPolarMap, Pyramid_LevelLayout) {
+    static_assert(SaliencyPolarMap::kPyramidLevels == 3);
+    static_assert(SaliencyPolarMap::LevelMatrix<1>::RowsAtCompileTime == 6);
+    static_assert(SaliencyPolarMap::LevelMatrix<1>::ColsAtCompileTime == 6);
+    static_assert(SaliencyPolarMap::LevelMatrix<2>::RowsAtCompileTime == 3);
+    static_assert(SaliencyPolarMap::LevelMatrix<2>::ColsAtCompileTime == 3);
+    static_assert(BasicSaliencyPolarMap<4, 6, 6>::kPyramidLevels == 2);
+    static_assert(BasicSaliencyPolarMap<4, 6, 5>::kPyramidLevels == 1);
+}
+
+TEST(SaliencyPolarMap, Pyramid_SetChannelBuildsAveragedLevels) {
+    SaliencyPolarMap spm;
+    Matrix12x12 field = Matrix12x12::Random();
+    spm.set_channel(ChannelID::F2, field);
+
+    const auto level1 = spm.pyramid_level<1>(ChannelID::F2);
+    const auto level2 = spm.pyramid_level<2>(ChannelID::F2);
+    for (int a = 0; a < 6; ++a) {
+        for (int b = 0; b < 6; ++b) {
+            const double expected = field.block<2, 2>(2 * a, 2 * b).mean();
+            EXPECT_NEAR(level1(a, b), expected, 4 * kEps);
+        }
+    }
+    for (int a = 0; a < 3; ++a) {
+        for (int b = 0; b < 3; ++b) {
+            const double expected = field.block<4, 4>(4 * a, 4 * b).mean();
+            EXPECT_NEAR(level2(a, b), expected, 4 * kEps);
+        }
+    }
+}
+
+TEST(SaliencyPolarMap, Pyramid_FollowsMutableChannelWrites) {
+    SaliencyPolarMap spm;
+    spm.fill_channel(ChannelID::F2, 0.5);
+    EXPECT_DOUBLE_EQ(spm.pyramid_level<2>(ChannelID::F2)(1, 1), 0.5);
+    EXPECT_DOUBLE_EQ(spm.gradient_magnitude_mean(ChannelID::F2, 1), 0.0);
+
+    spm.mutable_channel(ChannelID::F2)(0, 0) = 4.5;
+
+    EXPECT_DOUBLE_EQ(spm.pyramid_level<1>(ChannelID::F2)(0, 0), 1.5);
+    EXPECT_DOUBLE_EQ(spm.pyramid_level<2>(ChannelID::F2)(0, 0), 0.75);
+    EXPECT_GT(spm.gradient_magnitude_mean(ChannelID::F2, 1), 0.0);
+}
+
+TEST(SaliencyPolarMap, Pyramid_CoarseGradientOfLinearRamp) {
+    // r 方向の線形ランプ: r 内点の勾配はどの段でも（標準格子の）r ビンあたり 1、
+    // 両端列は Neumann 境界で 0 → 段 L の平均は (N_R^(L) - 2) / N_R^(L)
+    SaliencyPolarMap spm;
+    Matrix12x12 ramp;
+    for (int b = 0; b < 12; ++b) {
+        ramp.col(b).setConstant(static_cast<double>(b));
+    }
+    spm.set_channel(ChannelID::F2, ramp);
+
+    EXPECT_DOUBLE_EQ(spm.gradient_magnitude_mean(ChannelID::F2, 0),
+                     spm.gradient_magnitude_mean(ChannelID::F2));
+    for (int level = 0; level < SaliencyPolarMap::kPyramidLevels; ++level) {
+        const double n_r = static_cast<double>(12 >> level);
+        EXPECT_NEAR(spm.gradient_magnitude_mean(ChannelID::F2, level), (n_r - 2.0) / n_r, 4 * kEps)
+            << "level " << level;
+    }
+    EXPECT_NEAR(pyramid::gradient_magnitude_mean(spm.pyramid_level<1>(ChannelID::F2), 1),
+                spm.gradient_magnitude_mean(ChannelID::F2, 1), 1e-15);
+}
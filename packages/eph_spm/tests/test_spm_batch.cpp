@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "eph_spm/spm_batch.hpp"
+
+using namespace eph;
+using namespace eph::spm;
+
+// === 基本機能テスト ===
+
+TEST(SpmBatch, Constructor_InitializesToZero) {
+    SpmBatch batch(5);
+
+    EXPECT_EQ(batch.size(), 5u);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        for (int ch = 0; ch < 10; ++ch) {
+            EXPECT_DOUBLE_EQ(batch.agent(i).channel(static_cast<ChannelID>(ch)).norm(), 0.0)
+                << "Non-zero initial value at (agent=" << i << ", ch=" << ch << ")";
+        }
+    }
+}
+
+TEST(SpmBatch, AgentViews_AreContiguousInOneBuffer) {
+    SpmBatch batch(4);
+
+    // エージェントブロックは (10 + 時間チャネル追加2列)×144 要素ずつ連続に並ぶ
+    static_assert(SpmBatch::kAgentSize == 12 * 144);
+    for (size_t i = 0; i + 1 < batch.size(); ++i) {
+        EXPECT_EQ(batch.agent(i + 1).data() - batch.agent(i).data(), SpmBatch::kAgentSize);
+    }
+    EXPECT_EQ(batch.agent(0).data(), batch.data());
+
+    // 各チャネルはマップと同一のオフセット
+    auto view = batch.agent(2);
+    EXPECT_EQ(view.channel(ChannelID::F2).data() - view.data(), 5 * 144);
+}
+
+TEST(SpmBatch, SetChannel_IndependentAgents) {
+    SpmBatch batch(3);
+    Matrix12x12 data = Matrix12x12::Random();
+
+    batch.agent(1).set_channel(ChannelID::F2, data);
+
+    EXPECT_TRUE(batch.agent(1).get_channel(ChannelID::F2).isApprox(data, 1e-10));
+    EXPECT_DOUBLE_EQ(batch.agent(0).get_channel(ChannelID::F2).norm(), 0.0);
+    EXPECT_DOUBLE_EQ(batch.agent(2).get_channel(ChannelID::F2).norm(), 0.0);
+    EXPECT_DOUBLE_EQ(batch.agent(1).get_channel(ChannelID::F1).norm(), 0.0);
+}
+
+TEST(SpmBatch, AssignFromMap_MatchesMapDerivedQuantities) {
+    SaliencyPolarMap spm;
+    for (int ch = 0; ch < 10; ++ch) {
+        spm.set_channel(static_cast<ChannelID>(ch), Matrix12x12::Random());
+    }
+
+    SpmBatch batch(2);
+    batch.agent(1).assign(spm);
+    const SpmBatch& cbatch = batch;
+    auto view = cbatch.agent(1);
+
+    for (int ch = 0; ch < 10; ++ch) {
+        auto id = static_cast<ChannelID>(ch);
+        EXPECT_TRUE(view.get_channel(id).isApprox(spm.get_channel(id), 1e-12));
+        EXPECT_EQ(view.gradient_magnitude_mean(id), spm.gradient_magnitude_mean(id));
+        EXPECT_EQ(view.channel_mean(id), spm.channel_mean(id));
+    }
+}
+
+// === バッチカーネルテスト ===
+
+TEST(SpmBatch, ChannelBlock_SpansAllAgents) {
+    SpmBatch batch(3);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        batch.agent(i).set_channel(ChannelID::R1, Matrix12x12::Constant(static_cast<Scalar>(i)));
+    }
+
+    auto block = batch.channel_block(ChannelID::R1);
+    EXPECT_EQ(block.rows(), 144);
+    EXPECT_EQ(block.cols(), 3);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_DOUBLE_EQ(block.col(i).mean(), static_cast<double>(i));
+    }
+
+    // ブロック経由の書き込みは各エージェントに反映される
+    block.col(0).setConstant(0.5);
+    EXPECT_DOUBLE_EQ(batch.agent(0).channel_mean(ChannelID::R1), 0.5);
+}
+
+TEST(SpmBatch, GradientMagnitudeMeanAll_MatchesPerAgent) {
+    SpmBatch batch(6);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        batch.agent(i).set_channel(ChannelID::F2, Matrix12x12::Random());
+    }
+
+    SpmBatch::Vector means;
+    batch.gradient_magnitude_mean_all(ChannelID::F2, means);
+
+    ASSERT_EQ(means.size(), 6);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        EXPECT_EQ(means(static_cast<Eigen::Index>(i)),
+                  batch.agent(i).gradient_magnitude_mean(ChannelID::F2));
+    }
+}
+
+TEST(SpmBatch, PyramidGradientMean_MatchesMap) {
+    SpmBatch batch(1);
+    SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    batch.agent(0).assign(spm);
+
+    for (int level = 0; level < SaliencyPolarMap::kPyramidLevels; ++level) {
+        EXPECT_DOUBLE_EQ(batch.agent(0).gradient_magnitude_mean(ChannelID::F2, level),
+                         spm.gradient_magnitude_mean(ChannelID::F2, level))
+            << "level " << level;
+    }
+}
+
+TEST(SpmBatch, TemporalChannels_MatchMapPath) {
+    SpmBatch batch(3);
+    SaliencyPolarMap spm;
+
+    for (int k = 0; k < 6; ++k) {
+        const Matrix12x12 occ = (Matrix12x12::Random().array() > 0.0).cast<Scalar>().matrix();
+
+        spm.begin_frame();
+        spm.set_channel(ChannelID::F0, occ);
+        spm.update_temporal();
+
+        batch.begin_frame();
+        batch.agent(1).set_channel(ChannelID::F0, occ);
+        batch.update_temporal();
+    }
+
+    for (ChannelID id : {ChannelID::F0, ChannelID::R0, ChannelID::F5}) {
+        EXPECT_EQ(batch.agent(1).get_channel(id), spm.get_channel(id));
+    }
+    EXPECT_EQ(batch.agent(1).previous_occupancy(), spm.previous_occupancy());
+
+    // channel_block も現フレームの占有を指す
+    EXPECT_EQ(batch.channel_block(ChannelID::F0).col(1).data(), batch.agent(1).channel(ChannelID::F0).data());
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "eph_spm/spm_recording.hpp"
+
+using namespace eph;
+using namespace eph::spm;
+
+namespace {
+
+std::string temp_path(const std::string& name) {
+    return ::testing::TempDir() + name;
+}
+
+// フレーム t・エージェント i ごとに異なる値
+void fill_frame(SpmBatch& batch, int t) {
+    for (size_t i = 0; i < batch.size(); ++i) {
+        for (int ch = 0; ch < 10; ++ch) {
+            batch.agent(i).set_channel(static_cast<ChannelID>(ch),
+                Matrix12x12::Constant(100.0 * t + 10.0 * i + ch) + Matrix12x12::Random() * 0.1);
+        }
+    }
+}
+
+}  // namespace
+
+// === 書き込み → mmap 読み出し ===
+
+TEST(SpmRecording, RoundTrip_FramesMatchBatch) {
+    const std::string path = temp_path("roundtrip.spm");
+    SpmBatch batch(3);
+    std::vector<SpmBatch> frames;
+
+    {
+        SpmRecorder recorder(path, batch.size(), 0.1);
+        for (int t = 0; t < 4; ++t) {
+            batch.begin_frame();  // 占有の表裏入れ替え後も論理チャネル順で記録される
+            fill_frame(batch, t);
+            recorder.append_frame(batch);
+            frames.push_back(batch);
+        }
+        EXPECT_EQ(recorder.frames(), 4u);
+    }
+
+    SpmRecording recording(path);
+    EXPECT_EQ(recording.n_agents(), 3u);
+    EXPECT_EQ(recording.n_frames(), 4u);
+    EXPECT_DOUBLE_EQ(recording.dt(), 0.1);
+
+    for (size_t t = 0; t < frames.size(); ++t) {
+        for (size_t i = 0; i < 3; ++i) {
+            for (int ch = 0; ch < 10; ++ch) {
+                const auto id = static_cast<ChannelID>(ch);
+                EXPECT_EQ(recording.agent(t, i).channel(id), frames[t].agent(i).channel(id))
+                    << "Mismatch at (frame=" << t << ", agent=" << i << ", ch=" << ch << ")";
+            }
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST(SpmRecording, ReplayViews_ProvideDerivedQuantities) {
+    const std::string path = temp_path("derived.spm");
+    SaliencyPolarMap map;
+    map.set_channel(ChannelID::F2, Matrix12x12::Random());
+    {
+        SpmRecorder recorder(path, 1, 0.1);
+        recorder.append_agent(map);
+    }
+
+    SpmRecording recording(path);
+    const auto view = recording.agent(0, 0);
+    EXPECT_EQ(view.gradient_magnitude(ChannelID::F2), map.gradient_magnitude(ChannelID::F2));
+    EXPECT_DOUBLE_EQ(view.gradient_magnitude_mean(ChannelID::F2), map.gradient_magnitude_mean(ChannelID::F2));
+    std::remove(path.c_str());
+}
+
+// === 形式検証 ===
+
+TEST(SpmRecording, Open_RejectsMismatchedScalarType) {
+    const std::string path = temp_path("float.spm");
+    {
+        BasicSpmRecorder<10, 12, 12, float> recorder(path, 1, 0.1);
+        recorder.append_agent(BasicSaliencyPolarMap<10, 12, 12, float>());
+    }
+    EXPECT_THROW((BasicSpmRecording<10, 12, 12, double>(path)), std::runtime_error);
+    EXPECT_NO_THROW((BasicSpmRecording<10, 12, 12, float>(path)));
+    std::remove(path.c_str());
+}
+
+TEST(SpmRecording, Open_RejectsGarbageAndTruncation) {
+    const std::string garbage = temp_path("garbage.spm");
+    {
+        std::ofstream out(garbage, std::ios::binary);
+        out << std::string(128, 'x');
+    }
+    EXPECT_THROW(SpmRecording{garbage}, std::runtime_error);
+    EXPECT_THROW(SpmRecording{temp_path("missing.spm")}, std::runtime_error);
+
+    // ヘッダのフレーム数に対して本体が足りない
+    const std::string truncated = temp_path("truncated.spm");
+    {
+        SpmRecorder recorder(truncated, 2, 0.1);
+        SpmBatch batch(2);
+        recorder.append_frame(batch);
+        recorder.append_frame(batch);
+    }
+    {
+        std::ifstream in(truncated, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(truncated, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 8));
+    }
+    EXPECT_THROW(SpmRecording{truncated}, std::runtime_error);
+
+    std::remove(garbage.c_str());
+    std::remove(truncated.c_str());
+}
+
+TEST(SpmRecording, Open_RejectsOverflowingFrameCount) {
+    const std::string path = temp_path("overflow.spm");
+    {
+        SpmRecorder recorder(path, 1, 0.1);
+        recorder.append_frame(SpmBatch(1));
+    }
+    // n_frames·n_agents = 2^64 は 64bit で 0 に桁あふれする
+    {
+        std::fstream io(path, std::ios::binary | std::ios::in | std::ios::out);
+        const std::uint64_t huge = std::uint64_t{1} << 32;
+        io.seekp(static_cast<std::streamoff>(offsetof(SpmRecordingHeader, n_agents)));
+        io.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+        io.seekp(static_cast<std::streamoff>(offsetof(SpmRecordingHeader, n_frames)));
+        io.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    EXPECT_THROW(SpmRecording{path}, std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(SpmRecording, FrameCountInterval_CommitsHeaderBeforeClose) {
+    const std::string path = temp_path("interval.spm");
+    const std::string deferred = temp_path("deferred.spm");
+    SpmBatch batch(2);
+    SpmRecorder recorder(path, batch.size(), 0.1, 2);
+    SpmRecorder recorder_deferred(deferred, batch.size(), 0.1);
+    for (int t = 0; t < 3; ++t) {
+        recorder.append_frame(batch);
+        recorder_deferred.append_frame(batch);
+    }
+
+    // 間隔指定あり: 2フレーム目で書き戻し済み。既定: close() まで 0 のまま
+    EXPECT_EQ(SpmRecording(path).n_frames(), 2u);
+    EXPECT_EQ(SpmRecording(deferred).n_frames(), 0u);
+
+    recorder.close();
+    recorder_deferred.close();
+    EXPECT_EQ(SpmRecording(path).n_frames(), 3u);
+    EXPECT_EQ(SpmRecording(deferred).n_frames(), 3u);
+    std::remove(path.c_str());
+    std::remove(deferred.c_str());
+}
+
+TEST(SpmRecording, Close_RejectsPartialFrame) {
+    const std::string path = temp_path("partial.spm");
+    SpmRecorder recorder(path, 2, 0.1);
+    recorder.append_agent(SaliencyPolarMap());
+    EXPECT_THROW(recorder.close(), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <type_traits>
+#include "eph_core/math_utils.hpp"
+#include "eph_spm/separable_blur.hpp"
+#include "eph_spm/stencil.hpp"
+
+using namespace eph;
+using namespace eph::spm::stencil;
+
+namespace {
+
+// 丸め誤差の許容（Scalar の機械イプシロン基準。倍精度・単精度の両構成で実行）
+constexpr Scalar kEps = std::numeric_limits<Scalar>::epsilon();
+
+}  // namespace
+
+// === 境界ポリシー・近傍テーブル ===
+
+TEST(Stencil, BoundaryPolicies) {
+    static_assert(Periodic::index(-1, 12) == 11);
+    static_assert(Periodic::index(12, 12) == 0);
+    static_assert(Reflect::index(-1, 12) == 1);
+    static_assert(Reflect::index(12, 12) == 10);
+    static_assert(Reflect::index(-1, 1) == 0);
+    static_assert(Clamp::index(-1, 12) == 0);
+    static_assert(Clamp::index(12, 12) == 11);
+
+    // 従来のインデックス関数と一致
+    for (int i = -3; i < 15; ++i) {
+        EXPECT_EQ(Periodic::index(i, 12), math::wrap_index(i, 12)) << i;
+        EXPECT_EQ(Clamp::index(i, 12), math::clamp_index(i, 12)) << i;
+    }
+}
+
+TEST(Stencil, NeighborTable_IsCompileTime) {
+    constexpr auto& minus = NeighborTable<Periodic, 12, -1>::kIndex;
+    static_assert(minus[0] == 11 && minus[5] == 4);
+    constexpr auto& plus = NeighborTable<Reflect, 6, 1>::kIndex;
+    static_assert(plus[5] == 4 && plus[0] == 1);
+}
+
+// === 列演算としての演算子 ===
+
+TEST(Stencil, FivePointLaplacian_MatchesIndexLoop) {
+    // 新しい演算子（ラプラシアン）をエンジンの列演算として書く例
+    Matrix12x12 field = Matrix12x12::Random();
+    Matrix12x12 laplacian;
+    PolarSmoothing::for_each_column<12>(field, [&](const auto& col) {
+        constexpr int b = std::decay_t<decltype(col)>::kColumn;
+        laplacian.col(b) = (col.template at<1, 0>() + col.template at<-1, 0>() +
+                            col.template at<0, 1>() + col.template at<0, -1>() -
+                            4.0 * col.template at<0, 0>()).matrix();
+    });
+
+    for (int a = 0; a < 12; ++a) {
+        for (int b = 0; b < 12; ++b) {
+            const Scalar expected =
+                field(math::wrap_index(a + 1, 12), b) + field(math::wrap_index(a - 1, 12), b) +
+                field(a, math::clamp_index(b + 1, 12)) + field(a, math::clamp_index(b - 1, 12)) -
+                Scalar(4.0) * field(a, b);
+            EXPECT_DOUBLE_EQ(laplacian(a, b), expected) << "(" << a << ", " << b << ")";
+        }
+    }
+}
+
+TEST(Stencil, PartialRows_ReadWrappedNeighbors) {
+    // 先頭9行のみ出力しても、端行の近傍は全行から周期的に読む
+    Eigen::Matrix<double, 12, 3> field;
+    for (int a = 0; a < 12; ++a) {
+        field.row(a).setConstant(static_cast<double>(a));
+    }
+
+    PolarDerivative::for_each_column<9>(field, [&](const auto& col) {
+        using Col = std::decay_t<decltype(col)>;
+        const auto up = col.template at<1, 0>();
+        const auto down = col.template at<-1, 0>();
+        static_assert(Col::Values::RowsAtCompileTime == 9);
+        EXPECT_DOUBLE_EQ(down(0), 11.0);
+        EXPECT_DOUBLE_EQ(up(8), 9.0);
+        EXPECT_DOUBLE_EQ(up(3), 4.0);
+    });
+}
+
+TEST(Stencil, SymmetricRNeighbors_AtReflectedEdges) {
+    using Field = Eigen::Matrix<double, 6, 4>;
+    using Edge = PolarDerivative::Column<Field, 6, 0>;
+    using Inner = PolarDerivative::Column<Field, 6, 1>;
+    using Last = PolarDerivative::Column<Field, 6, 3>;
+    static_assert(Edge::kSymmetricR<1>);
+    static_assert(!Inner::kSymmetricR<1>);
+    static_assert(Last::kSymmetricR<1>);
+    static_assert(!PolarSmoothing::Column<Field, 6, 0>::kSymmetricR<1>);
+}
+
+// === 分離可能ブラー ===
+
+TEST(Stencil, BinomialKernel_IsCompileTime) {
+    using K4 = spm::blur::Binomial<4>;
+    static_assert(K4::kRadius == 2 && K4::kSum == 16);
+    static_assert(K4::kWeights[0] == 1 && K4::kWeights[1] == 4 && K4::kWeights[2] == 6);
+    static_assert(spm::blur::Binomial<16>::kWeights[8] == 12870);
+}
+
+TEST(Stencil, SeparableBlur_MatchesDirect2DKernel) {
+    constexpr int kRows = 9;
+    using K = spm::blur::Binomial<4>;
+    const Matrix12x12 field = Matrix12x12::Random();
+
+    Matrix12x12 out = Matrix12x12::Zero();
+    spm::blur::separable<4, kRows>(field, out);
+
+    for (int a = 0; a < kRows; ++a) {
+        for (int b = 0; b < 12; ++b) {
+            Scalar sum = 0.0;
+            for (int da = -K::kRadius; da <= K::kRadius; ++da) {
+                for (int db = -K::kRadius; db <= K::kRadius; ++db) {
+                    sum += K::weight(da) * K::weight(db) *
+                           field(Periodic::index(a + da, 12), Clamp::index(b + db, 12));
+                }
+            }
+            EXPECT_NEAR(out(a, b), sum / (K::kSum * K::kSum), 4 * kEps) << a << "," << b;
+        }
+    }
+    // 出力行以外は変更しない
+    EXPECT_EQ(out.bottomRows<12 - kRows>().norm(), 0.0);
+}
+
+TEST(Stencil, SeparableBlur_UniformMatchesFieldExactly) {
+    const Scalar value = 0.3712;
+    Matrix12x12 out;
+    spm::blur::separable<8, 12>(Matrix12x12::Constant(value), out);
+    EXPECT_TRUE((out.array() == spm::blur::uniform_separable<8>(value)).all());
+
+    spm::blur::direct<2, 12>(Matrix12x12::Constant(value), out);
+    EXPECT_TRUE((out.array() == spm::blur::uniform_direct<2>(value)).all());
+}
+
+TEST(Stencil, DirectBlur_MatchesSeparable) {
+    const Matrix12x12 field = Matrix12x12::Random();
+    Matrix12x12 direct_out;
+    Matrix12x12 separable_out;
+    spm::blur::direct<4, 12>(field, direct_out);
+    spm::blur::separable<4, 12>(field, separable_out);
+    EXPECT_TRUE(direct_out.isApprox(separable_out, 8 * kEps));
+}
+
+TEST(Stencil, SeparableBlur_NeededRowsCoverKernelRadius) {
+    // 視野 9 行・全 12 行: 半径1では死角の両端行のみ、半径2以上では全行を読む
+    EXPECT_TRUE((spm::blur::needed_row<2, 12, 9>(9)));
+    EXPECT_FALSE((spm::blur::needed_row<2, 12, 9>(10)));
+    EXPECT_TRUE((spm::blur::needed_row<2, 12, 9>(11)));
+    EXPECT_TRUE((spm::blur::needed_row<4, 12, 9>(10)));
+}
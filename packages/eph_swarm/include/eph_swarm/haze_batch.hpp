@@ -0,0 +1,177 @@
+#ifndef EPH_SWARM_HAZE_BATCH_HPP
+#define EPH_SWARM_HAZE_BATCH_HPP
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include "eph_core/types.hpp"
+#include "eph_core/constants.hpp"
+#include "eph_core/math_utils.hpp"
+#include "eph_agent/haze_estimator.hpp"
+
+namespace eph::swarm {
+
+/**
+ * @brief 群全体のHaze推定ステージ（N エージェント分の連続配列）
+ *
+ * 全エージェントのHaze推定器の状態（スカラーEMA・初期化フラグ）を長さ N の
+ * 連続配列に、推定したHazeを 144×N の連続配列（エージェント i は列 i、12×12 の
+ * 列優先）に持ち、2段階で処理する。
+ *
+ * 1. EMA更新: 全エージェントの α·e + (1-α)·EMA を連続配列上の1ループで
+ * 2. Haze推定: エージェントを kBlock 個ずつのブロックに分けて並列に、
+ *    各エージェントは HazeEstimator の融合カーネル（r 列単位のSIMD）で
+ *    出力列へ直接書く
+ *
+ * 各エージェントの結果は同じ設定（τ, σ, Mode）の BasicHazeEstimator<Mode> を
+ * エージェントごとに estimate() した結果とビット単位で一致する（単精度でも）。
+ * EMA更新は推定器の blend_ema()、Haze推定は推定器と同じ融合カーネルを
+ * エージェント1つ分ずつ呼ぶため、両経路の演算は要素ごとに同一になる
+ * （エージェントをまたいだ配列演算にはしない: SIMD の端数要素の扱いが変わるため）。
+ * OpenMP が有効なビルドではブロックを並列実行し、無効なら逐次実行する。
+ *
+ * EMAはエージェント側の推定器とも load() / store() で受け渡す
+ * （SwarmManager は毎ステップ読み込み・書き戻しを行い、エージェント単位の
+ * update() と混在させてもよい）。ビンごとのEMAフィールドは扱わないため、
+ * 受け渡せる推定器は accepts() が真のもの（スカラーEMA・同じ τ, σ）に限る。
+ *
+ * @tparam Mode Sigmoid の精度モード
+ */
+template <math::SigmoidMode Mode>
+class BasicHazeBatch {
+public:
+    using Scalar = eph::Scalar;
+    using Matrix12x12 = eph::Matrix12x12;
+    using Estimator = agent::BasicHazeEstimator<Mode>;
+    using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+    using HazeStorage = Eigen::Matrix<Scalar, constants::N_THETA * constants::N_R, Eigen::Dynamic>;
+
+    // 並列処理のブロック（エージェント数）
+    static constexpr std::ptrdiff_t kBlock = 64;
+
+    /**
+     * @brief コンストラクタ
+     * @param tau EMA時定数（EPHAgent の推定器と同じ既定値 1.0）
+     * @param blur_sigma 平滑化の標準偏差 [ビン]
+     */
+    explicit BasicHazeBatch(Scalar tau = 1.0, Scalar blur_sigma = Estimator::kDefaultBlurSigma)
+        : estimator_(tau, blur_sigma) {}
+
+    /**
+     * @brief エージェント数の変更（追加分は未初期化、Hazeは0）
+     */
+    void resize(std::size_t n) {
+        const auto old_n = size();
+        const auto new_n = static_cast<Eigen::Index>(n);
+        ema_error_.conservativeResize(new_n);
+        initialized_.conservativeResize(new_n);
+        haze_.conservativeResize(Eigen::NoChange, new_n);
+        if (new_n > old_n) {
+            ema_error_.tail(new_n - old_n).setZero();
+            initialized_.tail(new_n - old_n).setZero();
+            haze_.rightCols(new_n - old_n).setZero();
+        }
+    }
+
+    auto size() const -> Eigen::Index {
+        return ema_error_.size();
+    }
+
+    // カーネルの設定（τ, σ）
+    auto estimator() const -> const Estimator& {
+        return estimator_;
+    }
+
+    /**
+     * @brief 推定器の状態をバッチで受け渡せるか
+     *
+     * スカラーEMAで、τ・σ がバッチと同じ推定器のみ。ビンごとのEMAフィールドを
+     * 持つ推定器は、バッチで推定するとフィールドが無視され、store() でスカラーEMAに
+     * 置き換わるため受け渡せない（エージェント単位で推定すること）。
+     */
+    auto accepts(const Estimator& estimator) const -> bool {
+        return !estimator.has_ema_field() &&
+               estimator.tau() == estimator_.tau() &&
+               estimator.blur_sigma() == estimator_.blur_sigma();
+    }
+
+    /**
+     * @brief エージェント i の推定器からEMA状態を読み込む（accepts(estimator) であること）
+     */
+    void load(std::size_t i, const Estimator& estimator) {
+        assert(accepts(estimator));
+        const auto k = static_cast<Eigen::Index>(i);
+        ema_error_(k) = estimator.ema_error();
+        initialized_(k) = estimator.initialized() ? 1 : 0;
+    }
+
+    /**
+     * @brief エージェント i のEMA状態を推定器へ書き戻す（未初期化なら何もしない）
+     */
+    void store(std::size_t i, Estimator& estimator) const {
+        const auto k = static_cast<Eigen::Index>(i);
+        if (initialized_(k)) {
+            estimator.set_ema_error(ema_error_(k));
+        }
+    }
+
+    // エージェント i の予測誤差のEMA
+    auto ema_error(std::size_t i) const -> Scalar {
+        return ema_error_(static_cast<Eigen::Index>(i));
+    }
+
+    /**
+     * @brief エージェント i の推定Haze（連続配列上のビュー）
+     */
+    auto haze(std::size_t i) const -> Eigen::Map<const Matrix12x12> {
+        return Eigen::Map<const Matrix12x12>(haze_.col(static_cast<Eigen::Index>(i)).data());
+    }
+
+    /**
+     * @brief 全エージェントのHaze推定（estimate() の一括版）
+     *
+     * @param spm_for エージェントIDからSPMを返す関数（spm_for(i)、並列に呼ばれる）
+     * @param prediction_errors エージェントごとの予測誤差 [0, 1]（長さ size()）
+     */
+    template <typename SpmFor>
+    void estimate(SpmFor&& spm_for, const Array& prediction_errors) {
+        assert(prediction_errors.size() == size());
+        const Eigen::Index n = size();
+
+        // 1. EMA更新（連続配列）
+        for (Eigen::Index k = 0; k < n; ++k) {
+            ema_error_(k) = initialized_(k)
+                ? estimator_.blend_ema(ema_error_(k), prediction_errors(k))
+                : prediction_errors(k);
+        }
+        initialized_.setOnes();
+
+        // 2. Haze推定（ブロック並列、出力列へ直接）
+        const std::ptrdiff_t blocks = (static_cast<std::ptrdiff_t>(n) + kBlock - 1) / kBlock;
+
+        #pragma omp parallel for schedule(static)
+        for (std::ptrdiff_t block = 0; block < blocks; ++block) {
+            const auto begin = static_cast<Eigen::Index>(block * kBlock);
+            const auto end = std::min<Eigen::Index>(begin + kBlock, n);
+            for (Eigen::Index k = begin; k < end; ++k) {
+                Eigen::Map<Matrix12x12> out(haze_.col(k).data());
+                estimator_.haze_from_ema(spm_for(static_cast<std::size_t>(k)), ema_error_(k), out);
+            }
+        }
+    }
+
+private:
+    Estimator estimator_;                                   // カーネルの設定（状態は使わない）
+    Array ema_error_;                                       // 予測誤差のEMA（N）
+    Eigen::Array<std::uint8_t, Eigen::Dynamic, 1> initialized_;  // EMA初期化済みか（N）
+    HazeStorage haze_;                                      // 推定Haze（144×N）
+};
+
+// 既定のHazeバッチ（EPHAgent の HazeEstimator と同じ厳密Sigmoid）
+using HazeBatch = BasicHazeBatch<math::SigmoidMode::Exact>;
+
+}  // namespace eph::swarm
+
+#endif  // EPH_SWARM_HAZE_BATCH_HPP
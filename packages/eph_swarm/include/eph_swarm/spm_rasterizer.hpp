@@ -0,0 +1,208 @@
+#ifndef EPH_SWARM_SPM_RASTERIZER_HPP
+#define EPH_SWARM_SPM_RASTERIZER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include "eph_core/types.hpp"
+#include "eph_core/constants.hpp"
+#include "eph_spm/channel_set.hpp"
+#include "eph_spm/polar_grid.hpp"
+#include "eph_spm/spm_batch.hpp"
+#include "eph_swarm/swarm_manager.hpp"
+
+namespace eph::swarm {
+
+/**
+ * @brief 自己中心SPMラスタライザのパラメータ（appendix B §5 推奨値）
+ */
+struct RasterizerParams {
+    Scalar perception_radius = constants::SPM_PERCEPTION_RADIUS;  // r_max [m]
+    size_t max_neighbors = constants::SPM_MAX_NEIGHBORS;          // 知覚する近傍数上限
+    Scalar motion_pressure_alpha = constants::MOTION_PRESSURE_ALPHA;
+    Scalar motion_pressure_eps = constants::MOTION_PRESSURE_EPS;
+    Scalar ttc_eps = constants::TTC_EPS;
+};
+
+/**
+ * @brief 近傍位置から各エージェントの自己中心SPM（F0/F1/F3）を生成する知覚ステージ
+ *
+ * SwarmManager の空間インデックスで近傍を引き、進行方向基準の方位角と距離で
+ * 12×12 極座標格子にビン分けする（ビン規約は eph_spm/polar_grid.hpp）。
+ *
+ * ## チャネル定義（セル (θ, r) に入る近傍 j について最大値を取る）
+ * - F0 occupancy: 近傍が1つでもあれば 1
+ * - F1 motion pressure: tanh(α v_in max(0, cosθ) / (r + ε))
+ * - F3 TTC proxy: clip(1 / (TTC + 1)),  TTC ≈ r / (v_in + ε_ttc)
+ *
+ * v_in = max(0, -(v_j - v_i)·ê_r) は接近速度、θ は進行方向基準の方位角。
+ * 停止中（|v| < EPS）のエージェントはワールド x 軸を進行方向とみなす。
+ * 死角（視野外θビン、spm::FovMask）に入る近傍は知覚しない。
+ *
+ * ## 並列化
+ * エージェント単位で独立（書き込み先は perception.agent(i) のみ）。
+ * OpenMP が有効なビルドではエージェントループを並列実行し、無効なら逐次実行する。
+ * k-d tree は並列ループの前に1回だけ構築する。
+ *
+ * ## 時間チャネル
+ * rasterize() はフレーム開始時に占有の表裏を入れ替え（perception.begin_frame()）、
+ * 各エージェントの F0 を書いた直後に R0（Δ占有）と F5（観測安定性）を増分更新する。
+ *
+ * ## 要求チャネル
+ * テンプレート引数 Requested（spm::ChannelMask）で消費側が読むチャネルを指定すると、
+ * その依存閉包に含まれるチャネルだけを生成する（例: EPHAgent::kReadChannels では
+ * F0 と R0/F5 のみ、tanh・TTC は計算しない）。F0/F1/F3 のいずれも不要なら
+ * 近傍探索も行わない。既定は全チャネル。
+ *
+ * 生成しないチャネル（F0/F1/F3/R0/F5 以外、および要求外）は変更しない。
+ */
+class SpmRasterizer {
+public:
+    using Scalar = eph::Scalar;
+    using Vec2 = eph::Vec2;
+
+    explicit SpmRasterizer(const RasterizerParams& params = RasterizerParams())
+        : params_(params) {}
+
+    /**
+     * @brief 要求チャネル集合から決まる生成対象（コンパイル時）
+     */
+    template <spm::ChannelMask Requested>
+    struct Outputs {
+        static constexpr spm::ChannelMask kChannels = spm::with_dependencies(Requested);
+        static constexpr bool kOccupancy = spm::contains(kChannels, ChannelID::F0);
+        static constexpr bool kPressure = spm::contains(kChannels, ChannelID::F1);
+        static constexpr bool kTtc = spm::contains(kChannels, ChannelID::F3);
+        static constexpr bool kTemporal = spm::SpmView::Temporal::kEnabled &&
+            (spm::contains(kChannels, ChannelID::R0) || spm::contains(kChannels, ChannelID::F5));
+        static constexpr bool kNeighbors = kOccupancy || kPressure || kTtc;
+    };
+
+    /**
+     * @brief 全エージェントの要求チャネル（F0/F1/F3 と R0/F5）を生成
+     * @tparam Requested 消費側が読むチャネル集合
+     * @param swarm 群（位置・速度の参照元）
+     * @param perception 出力（サイズが異なる場合はゼロ初期化して合わせる）
+     */
+    template <spm::ChannelMask Requested = spm::kAllChannels>
+    void rasterize(const SwarmManager& swarm, spm::SpmBatch& perception) const {
+        using Out = Outputs<Requested>;
+        if (perception.size() != swarm.size()) {
+            perception.resize(swarm.size());
+        }
+        if constexpr (!Out::kNeighbors) {
+            return;
+        }
+        swarm.build_spatial_index();
+        if constexpr (Out::kOccupancy) {
+            perception.begin_frame();
+        }
+
+        const auto n = static_cast<std::ptrdiff_t>(swarm.size());
+
+        #pragma omp parallel
+        {
+            SwarmManager::NeighborBuffer neighbors;
+            neighbors.hits.reserve(params_.max_neighbors + 1);
+
+            #pragma omp for schedule(static)
+            for (std::ptrdiff_t i = 0; i < n; ++i) {
+                rasterize_agent<Requested>(swarm, static_cast<size_t>(i), neighbors, perception.agent(static_cast<size_t>(i)));
+            }
+        }
+    }
+
+    /**
+     * @brief 1エージェント分の要求チャネル（F0/F1/F3 と R0/F5）を生成
+     * @tparam Requested 消費側が読むチャネル集合
+     * @param swarm 群（build_spatial_index() 済みであること）
+     * @param agent_id エージェントID
+     * @param neighbors 近傍検索の作業領域（スレッドごとに1つ）
+     * @param out 出力ビュー
+     */
+    template <spm::ChannelMask Requested = spm::kAllChannels>
+    void rasterize_agent(
+        const SwarmManager& swarm,
+        size_t agent_id,
+        SwarmManager::NeighborBuffer& neighbors,
+        const spm::SpmView& out
+    ) const {
+        using Out = Outputs<Requested>;
+        if constexpr (!Out::kNeighbors) {
+            return;
+        }
+
+        auto occupancy = cleared_channel<Out::kOccupancy>(out, ChannelID::F0);
+        auto pressure = cleared_channel<Out::kPressure>(out, ChannelID::F1);
+        auto ttc = cleared_channel<Out::kTtc>(out, ChannelID::F3);
+
+        const Vec2& self_velocity = swarm.velocity(agent_id);
+        const Scalar speed = self_velocity.norm();
+        const Vec2 heading = speed > constants::EPS ? Vec2(self_velocity / speed) : Vec2::UnitX();
+        const Scalar heading_angle = std::atan2(heading.y(), heading.x());
+
+        swarm.find_neighbors_within(agent_id, params_.perception_radius, params_.max_neighbors, neighbors);
+
+        for (const auto& hit : neighbors.hits) {
+            const Scalar dist = hit.distance;
+            const Vec2 e_r = dist > constants::EPS ? Vec2(hit.offset / dist) : heading;
+
+            const int a = spm::theta_bin(std::atan2(e_r.y(), e_r.x()) - heading_angle);
+            if (!spm::FovMask<>::visible(a)) {
+                continue;
+            }
+            const int b = spm::r_bin(dist, params_.perception_radius);
+
+            if constexpr (Out::kOccupancy) {
+                (*occupancy)(a, b) = Scalar(1.0);
+            }
+            if constexpr (!Out::kPressure && !Out::kTtc) {
+                continue;
+            }
+
+            // 接近速度 v_in と方位重み max(0, cosθ)
+            const Vec2 v_rel = swarm.velocity(hit.id) - self_velocity;
+            const Scalar v_in = std::max(Scalar(0.0), -v_rel.dot(e_r));
+
+            if constexpr (Out::kPressure) {
+                const Scalar forward = std::max(Scalar(0.0), heading.dot(e_r));
+                const Scalar f1 = v_in * forward > Scalar(0.0)
+                    ? std::tanh(params_.motion_pressure_alpha * v_in * forward / (dist + params_.motion_pressure_eps))
+                    : Scalar(0.0);
+                (*pressure)(a, b) = std::max((*pressure)(a, b), f1);
+            }
+            if constexpr (Out::kTtc) {
+                const Scalar time_to_collision = dist / (v_in + params_.ttc_eps);
+                const Scalar f3 = std::clamp(Scalar(1.0) / (time_to_collision + Scalar(1.0)), Scalar(0.0), Scalar(1.0));
+                (*ttc)(a, b) = std::max((*ttc)(a, b), f3);
+            }
+        }
+
+        if constexpr (Out::kTemporal) {
+            out.update_temporal();
+        }
+    }
+
+    auto params() const -> const RasterizerParams& { return params_; }
+
+private:
+    RasterizerParams params_;
+
+    // 生成するチャネルのみ書き込みビューを取ってゼロで初期化する（要求外のチャネルには触れない）
+    template <bool kWrite>
+    static auto cleared_channel(const spm::SpmView& out, ChannelID id)
+        -> std::optional<spm::SpmView::ChannelMap> {
+        if constexpr (kWrite) {
+            auto channel = out.mutable_channel(id);
+            channel.setZero();
+            return channel;
+        } else {
+            return std::nullopt;
+        }
+    }
+};
+
+}  // namespace eph::swarm
+
+#endif  // EPH_SWARM_SPM_RASTERIZER_HPP
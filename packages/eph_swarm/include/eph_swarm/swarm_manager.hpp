@@ -5,6 +5,7 @@
 #include <memory>
 #include <algorithm>
 #include <random>
+#include <utility>
 #include <cassert>
 #include <cstdint>
 #include <Eigen/Core>
@@ -14,6 +15,8 @@
 #include "eph_core/math_utils.hpp"
 #include "eph_agent/eph_agent.hpp"
 #include "eph_spm/saliency_polar_map.hpp"
+#include "eph_spm/spm_batch.hpp"
+#include "eph_swarm/haze_batch.hpp"
 
 namespace eph::swarm {
 
@@ -83,27 +86,35 @@ public:
     {
         agents_.reserve(n_agents);
         positions_.resize(n_agents);
+        velocities_.resize(n_agents);
 
         // エージェント初期化（ランダム配置・ランダム速度）
+        // 乱数は常に倍精度で生成（単精度構成でも同一の初期配置を再現するため）
         std::mt19937 rng(42);  // 再現性のためシード固定
-        std::uniform_real_distribution<Scalar> pos_dist(-10.0, 10.0);
-        std::uniform_real_distribution<Scalar> vel_mag_dist(0.3, 1.0);  // 初期速度大きさ
-        std::uniform_real_distribution<Scalar> vel_angle_dist(0.0, 2.0 * constants::PI);  // 方向
+        std::uniform_real_distribution<double> pos_dist(-10.0, 10.0);
+        std::uniform_real_distribution<double> vel_mag_dist(0.3, 1.0);  // 初期速度大きさ
+        std::uniform_real_distribution<double> vel_angle_dist(0.0, 2.0 * constants::PI);  // 方向
 
         for (size_t i = 0; i < n_agents; ++i) {
             AgentState state;
-            state.position = Vec2(pos_dist(rng), pos_dist(rng));
+            // 注: 従来の Vec2(pos_dist(rng), pos_dist(rng)) はGCCで右から評価されていたため、
+            //     既存の初期配置を保つよう y → x の順に引く
+            const double py = pos_dist(rng);
+            const double px = pos_dist(rng);
+            state.position = Vec2(static_cast<Scalar>(px), static_cast<Scalar>(py));
 
             // ランダム速度（対称性を破る）
-            Scalar speed = vel_mag_dist(rng);
-            Scalar angle = vel_angle_dist(rng);
-            state.velocity = Vec2(speed * std::cos(angle), speed * std::sin(angle));
+            const double speed = vel_mag_dist(rng);
+            const double angle = vel_angle_dist(rng);
+            state.velocity = Vec2(static_cast<Scalar>(speed * std::cos(angle)),
+                                  static_cast<Scalar>(speed * std::sin(angle)));
 
             state.kappa = 1.0;
             state.fatigue = 0.0;
 
             agents_.push_back(std::make_unique<agent::EPHAgent>(state, 1.0));
             positions_[i] = state.position;
+            velocities_[i] = state.velocity;
         }
     }
 
@@ -115,6 +126,53 @@ public:
         beta_ = beta;
     }
 
+    /**
+     * @brief 全エージェントの行為選択の方式を設定
+     *
+     * 勾配降下（既定）と候補サンプリングを実行中に切り替える（計算量と解の質の比較用）。
+     * 全エージェントに同じ方式・候補を設定する。後から個別のエージェントに
+     * EPHAgent::set_selection_mode() で別の方式・候補を設定した場合、そのステップは
+     * 群一括のバッチ経路を使わずエージェントごとの update() で更新する。
+     *
+     * @param mode 行為選択の方式
+     * @param lattice 速度候補（省略時は CandidateLattice::standard()、予算 M = 64）
+     */
+    void set_selection_mode(agent::SelectionMode mode,
+                            std::shared_ptr<const agent::CandidateLattice> lattice = nullptr) {
+        selection_mode_ = mode;
+        lattice_ = lattice ? std::move(lattice) : agent::CandidateLattice::standard();
+        for (auto& agent : agents_) {
+            agent->set_selection_mode(mode, lattice_);
+        }
+    }
+
+    auto selection_mode() const -> agent::SelectionMode {
+        return selection_mode_;
+    }
+
+    /**
+     * @brief 全エージェントの反復勾配降下（SelectionMode::LineSearch）の設定
+     */
+    void set_descent_options(const agent::DescentOptions& options) {
+        for (auto& agent : agents_) {
+            agent->set_descent_options(options);
+        }
+    }
+
+    /**
+     * @brief 直近ステップの行為選択の計算量（全エージェントの合計）
+     *
+     * iterations / evaluations の合計。1エージェントあたりの平均は size() で割る。
+     */
+    auto solver_stats() const -> agent::SolverStats {
+        agent::SolverStats total{0, 0};
+        for (const auto& agent : agents_) {
+            total.iterations += agent->solver_stats().iterations;
+            total.evaluations += agent->solver_stats().evaluations;
+        }
+        return total;
+    }
+
     /**
      * @brief β値取得
      * @return 現在のβ値
@@ -137,21 +195,23 @@ public:
      * @param dt タイムステップ [s]（推奨: 0.1）
      */
     void update_all_agents(const spm::SaliencyPolarMap& spm, Scalar dt) {
-        if (agents_.empty()) return;
-
-        // Stage 1: 各エージェントの状態更新
-        for (size_t i = 0; i < agents_.size(); ++i) {
-            agents_[i]->update(spm, dt);
-
-            // Stage 2: 位置同期
-            positions_[i] = agents_[i]->state().position;
-        }
-
-        // Stage 2.5: k-d tree無効化（positions_が更新された）
-        kdtree_dirty_ = true;
+        update_all_agents_with(
+            [&spm](size_t) -> const spm::SaliencyPolarMap& { return spm; }, dt);
+    }
 
-        // Stage 3: MB破れ適用
-        update_effective_haze();
+    /**
+     * @brief 全エージェントの状態更新（エージェント個別のSPM）
+     *
+     * エージェント i は perception.agent(i) のビューを知覚として使用します。
+     * SPMは1つの連続バッファに格納されるため、エージェントごとのヒープ確保は不要です。
+     *
+     * @param perception エージェントごとのSPM（perception.size() == size()）
+     * @param dt タイムステップ [s]
+     */
+    void update_all_agents(const spm::SpmBatch& perception, Scalar dt) {
+        assert(perception.size() == agents_.size());
+        update_all_agents_with(
+            [&perception](size_t i) { return perception.agent(i); }, dt);
     }
 
     /**
@@ -167,34 +227,7 @@ public:
      * stop-gradientにより、haze推定器の内部状態は汚染されません。
      */
     void update_effective_haze() {
-        if (agents_.empty()) return;
-
-        // Stage 1: 各エージェントの近傍平均hazeを計算
-        std::vector<Matrix12x12> neighbor_avg(agents_.size());
-
-        for (size_t i = 0; i < agents_.size(); ++i) {
-            auto neighbors = find_neighbors(i);
-
-            if (neighbors.empty()) {
-                // 近傍がない場合は自分自身のhazeを使用
-                neighbor_avg[i] = agents_[i]->haze();
-                continue;
-            }
-
-            Matrix12x12 avg = Matrix12x12::Zero();
-            for (size_t j : neighbors) {
-                avg += agents_[j]->haze();
-            }
-            avg /= static_cast<Scalar>(neighbors.size());
-            neighbor_avg[i] = avg;
-        }
-
-        // Stage 2: h_eff,i = (1-β)h_i + β⟨h_j⟩ を適用
-        for (size_t i = 0; i < agents_.size(); ++i) {
-            auto h_i = agents_[i]->haze();
-            auto h_eff = (1.0 - beta_) * h_i + beta_ * neighbor_avg[i];
-            agents_[i]->set_effective_haze(h_eff.eval());  // stop-gradient
-        }
+        mix_effective_haze([this](size_t j) -> const Matrix12x12& { return agents_[j]->haze(); });
     }
 
     /**
@@ -273,6 +306,125 @@ public:
         return neighbors;
     }
 
+    /**
+     * @brief 半径検索の結果1件
+     */
+    struct NeighborHit {
+        size_t id;        // 近傍エージェントID
+        Vec2 offset;      // 自分 → 近傍のトーラス最短変位 [m]
+        Scalar distance;  // |offset| [m]
+    };
+
+    /**
+     * @brief 半径検索の作業領域（スレッドごとに1つ用意し、検索間で再利用する）
+     *
+     * hits が結果。knn_index / knn_dist_sq は k-d tree の k-NN 結果の受け皿で、
+     * 検索のたびにヒープ確保しないよう容量を保持する。
+     */
+    struct NeighborBuffer {
+        std::vector<NeighborHit> hits;
+        std::vector<uint32_t> knn_index;
+        std::vector<Scalar> knn_dist_sq;
+    };
+
+    /**
+     * @brief 半径内近傍検索（k-d tree + トーラス周期像）
+     *
+     * トーラス距離 radius 以内の近傍を近い順に最大 max_count 個返します（自分自身は除外）。
+     *
+     * ## アルゴリズム
+     * 1. k-d tree で (max_count+1)-NN を検索し、radius 以内を採用
+     * 2. 境界から探索半径以内にある軸のみ、周期像（±WORLD_SIZE）でも検索
+     *    （max_count 個が埋まった時点で探索半径を最遠ヒットの距離まで縮める）
+     * 3. 距離でソートし、上位 max_count 個を返す
+     *
+     * ## スレッド安全性
+     * build_spatial_index() 後に位置更新がなければ、複数スレッドから同時に呼べます。
+     * 作業領域 buffer はスレッドごとに用意してください。
+     *
+     * @param agent_id エージェントID
+     * @param radius 検索半径 [m]（< WORLD_SIZE / 2）
+     * @param max_count 最大件数
+     * @param buffer 作業領域（結果は buffer.hits に上書き、距離昇順）
+     */
+    void find_neighbors_within(
+        size_t agent_id,
+        Scalar radius,
+        size_t max_count,
+        NeighborBuffer& buffer
+    ) const {
+        assert(radius < constants::WORLD_SIZE / Scalar(2.0));
+        auto& out = buffer.hits;
+        out.clear();
+        if (agent_id >= agents_.size() || max_count == 0) return;
+
+        rebuild_kdtree_if_needed();
+
+        const Vec2& pos = positions_[agent_id];
+        const size_t search_k = std::min(max_count + 1, agents_.size());
+        auto& ret_index = buffer.knn_index;
+        auto& ret_dist_sq = buffer.knn_dist_sq;
+        ret_index.resize(search_k);
+        ret_dist_sq.resize(search_k);
+        const Scalar radius_sq = radius * radius;
+
+        auto query = [&](const Vec2& q) {
+            const size_t num_results = kdtree_->knnSearch(
+                q.data(), search_k, ret_index.data(), ret_dist_sq.data());
+            for (size_t r = 0; r < num_results && ret_dist_sq[r] <= radius_sq; ++r) {
+                const size_t j = static_cast<size_t>(ret_index[r]);
+                if (j == agent_id) continue;
+                const Vec2 offset = math::torus_displacement(pos, positions_[j], constants::WORLD_SIZE);
+                out.push_back({j, offset, offset.norm()});
+            }
+        };
+
+        query(pos);
+
+        // 周期像: 探索半径内に境界がある軸のみ（R < WORLD_SIZE/2 なので重複しない）
+        Scalar reach = radius;
+        if (out.size() >= max_count) {
+            std::sort(out.begin(), out.end(),
+                [](const auto& a, const auto& b) { return a.distance < b.distance; });
+            reach = out[max_count - 1].distance;
+        }
+        const Scalar shift_x = pos.x() - constants::WORLD_MIN < reach ? constants::WORLD_SIZE
+                             : constants::WORLD_MAX - pos.x() < reach ? -constants::WORLD_SIZE
+                             : Scalar(0.0);
+        const Scalar shift_y = pos.y() - constants::WORLD_MIN < reach ? constants::WORLD_SIZE
+                             : constants::WORLD_MAX - pos.y() < reach ? -constants::WORLD_SIZE
+                             : Scalar(0.0);
+        if (shift_x != Scalar(0.0)) query(pos + Vec2(shift_x, Scalar(0.0)));
+        if (shift_y != Scalar(0.0)) query(pos + Vec2(Scalar(0.0), shift_y));
+        if (shift_x != Scalar(0.0) && shift_y != Scalar(0.0)) query(pos + Vec2(shift_x, shift_y));
+
+        std::sort(out.begin(), out.end(),
+            [](const auto& a, const auto& b) { return a.distance < b.distance; });
+        if (out.size() > max_count) {
+            out.resize(max_count);
+        }
+    }
+
+    /**
+     * @brief エージェント位置・速度（連続配列からの読み出し）
+     *
+     * エージェント本体を辿らずに済むため、近傍を多数参照する知覚ステージで使用します。
+     */
+    auto position(size_t i) const -> const Vec2& {
+        return positions_[i];
+    }
+
+    auto velocity(size_t i) const -> const Vec2& {
+        return velocities_[i];
+    }
+
+    /**
+     * @brief 空間インデックスの構築（位置更新後、並列クエリの前に呼ぶ）
+     */
+    void build_spatial_index() const {
+        rebuild_kdtree_if_needed();
+    }
+
     /**
      * @brief エージェント取得（非const）
      * @param i エージェントID
@@ -331,7 +483,165 @@ public:
         }
     }
 
+    /**
+     * @brief エージェント状態の設定（位置も同期）
+     * @param agent_id エージェントID
+     * @param state 新しい状態
+     */
+    void set_agent_state(size_t agent_id, const AgentState& state) {
+        if (agent_id < agents_.size()) {
+            agents_[agent_id]->set_state(state);
+            positions_[agent_id] = state.position;
+            velocities_[agent_id] = state.velocity;
+            kdtree_dirty_ = true;  // k-d tree無効化
+        }
+    }
+
 private:
+    /**
+     * @brief MB破れの共通実装
+     * @param haze_of エージェントID → 混合前のHaze（エージェントの haze() またはバッチの連続配列）
+     */
+    template <typename HazeOf>
+    void mix_effective_haze(HazeOf&& haze_of) {
+        if (agents_.empty()) return;
+
+        // Stage 1: 各エージェントの近傍平均hazeを計算
+        std::vector<Matrix12x12> neighbor_avg(agents_.size());
+
+        for (size_t i = 0; i < agents_.size(); ++i) {
+            auto neighbors = find_neighbors(i);
+
+            if (neighbors.empty()) {
+                // 近傍がない場合は自分自身のhazeを使用
+                neighbor_avg[i] = haze_of(i);
+                continue;
+            }
+
+            Matrix12x12 avg = Matrix12x12::Zero();
+            for (size_t j : neighbors) {
+                avg += haze_of(j);
+            }
+            avg /= static_cast<Scalar>(neighbors.size());
+            neighbor_avg[i] = avg;
+        }
+
+        // Stage 2: h_eff,i = (1-β)h_i + β⟨h_j⟩ を適用
+        for (size_t i = 0; i < agents_.size(); ++i) {
+            Matrix12x12 h_i = haze_of(i);
+            auto h_eff = (1.0 - beta_) * h_i + beta_ * neighbor_avg[i];
+            agents_[i]->set_effective_haze(h_eff.eval());  // stop-gradient
+        }
+    }
+
+    /**
+     * @brief 群一括のバッチ経路で更新できるか
+     *
+     * バッチ経路は群の selection_mode_ / lattice_ で全エージェントの行為を選び、
+     * Haze推定はスカラーEMAの連続配列で行うため、全エージェントの方式・候補が群の
+     * 設定と同じで、Haze推定器をバッチで受け渡せる（HazeBatch::accepts()）ときに限る。
+     */
+    auto batchable() const -> bool {
+        if (agent::ActionSelector::gradient_verification() ||
+            selection_mode_ == agent::SelectionMode::LineSearch) {
+            return false;
+        }
+        for (const auto& agent : agents_) {
+            if (agent->selection_mode() != selection_mode_) {
+                return false;
+            }
+            if (selection_mode_ == agent::SelectionMode::Sampling &&
+                &agent->candidate_lattice() != lattice_.get()) {
+                return false;
+            }
+            if (!haze_batch_.accepts(agent->haze_estimator())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief 状態更新の共通実装
+     * @param spm_for エージェントID → そのエージェントが参照するSPM
+     */
+    template <typename SpmFor>
+    void update_all_agents_with(SpmFor&& spm_for, Scalar dt) {
+        if (agents_.empty()) return;
+
+        // Stage 1: 各エージェントの状態更新
+        const bool batched = batchable();
+        if (!batched) {
+            // 検証モード: エージェントごとに中心差分勾配と比較しながら更新
+            // 直線探索: 反復回数がエージェントごとに異なるためエージェント単位
+            // 群と異なる行為選択の設定を持つエージェント、ビンごとのEMAフィールドを
+            // 持つHaze推定器がいる場合も同じ経路
+            for (size_t i = 0; i < agents_.size(); ++i) {
+                agents_[i]->update(spm_for(i), dt);
+            }
+        } else {
+            // 行為選択は全エージェントを1つのSoAカーネルで
+            // （select_action_with_efe() / select_action_sampled() とビット一致）
+            action_batch_.resize(static_cast<Eigen::Index>(agents_.size()), agent::ActionSelector::kContextSize);
+            for (size_t i = 0; i < agents_.size(); ++i) {
+                const auto k = static_cast<Eigen::Index>(i);
+                const agent::EPHAgent& agent = *agents_[i];
+                const AgentState& state = agent.state();
+                action_batch_.vx(k) = state.velocity.x();
+                action_batch_.vy(k) = state.velocity.y();
+                action_batch_.fatigue(k) = state.fatigue;
+                action_batch_.epistemic(k) =
+                    agent::ActionSelector::compute_epistemic(agent.haze(), spm_for(i), agent.spm_level());
+                if constexpr (agent::ActionSelector::kContextSize > 0) {
+                    action_batch_.context.row(k) = agent::ActionSelector::compute_context(
+                        agent.haze(), spm_for(i), agent.spm_level()).transpose();
+                }
+            }
+            if (selection_mode_ == agent::SelectionMode::Sampling) {
+                agent::ActionSelector::select_action_sampled_batch(action_batch_, *lattice_);
+            } else {
+                agent::ActionSelector::select_action_batch(action_batch_);
+            }
+
+            // 状態更新はエージェントごと、Haze推定は群全体の連続配列で
+            // （apply_action() とビット一致。EMAは推定器と読み込み・書き戻し）
+            haze_batch_.resize(agents_.size());
+            prediction_errors_.resize(static_cast<Eigen::Index>(agents_.size()));
+            for (size_t i = 0; i < agents_.size(); ++i) {
+                const auto k = static_cast<Eigen::Index>(i);
+                agent::EPHAgent& agent = *agents_[i];
+
+                agent::ActionSelection selection;
+                selection.velocity = Vec2(action_batch_.vx(k), action_batch_.vy(k));
+                selection.efe.epistemic = action_batch_.epistemic(k);
+                selection.efe.pragmatic = action_batch_.pragmatic(k);
+                prediction_errors_(k) = agent.apply_motion(selection, dt);
+                haze_batch_.load(i, agent.haze_estimator());
+            }
+
+            haze_batch_.estimate(spm_for, prediction_errors_);
+            for (size_t i = 0; i < agents_.size(); ++i) {
+                haze_batch_.store(i, agents_[i]->haze_estimator());
+            }
+        }
+
+        // Stage 2: 位置同期
+        for (size_t i = 0; i < agents_.size(); ++i) {
+            positions_[i] = agents_[i]->state().position;
+            velocities_[i] = agents_[i]->state().velocity;
+        }
+
+        // Stage 2.5: k-d tree無効化（positions_が更新された）
+        kdtree_dirty_ = true;
+
+        // Stage 3: MB破れ適用（バッチ経路では推定直後のHazeを連続配列から読む）
+        if (batched) {
+            mix_effective_haze([this](size_t j) { return haze_batch_.haze(j); });
+        } else {
+            update_effective_haze();
+        }
+    }
+
     /**
      * @brief k-d tree再構築（lazy rebuild）
      *
@@ -354,6 +664,13 @@ private:
 
     std::vector<std::unique_ptr<agent::EPHAgent>> agents_;  // エージェント群
     std::vector<Vec2> positions_;                           // エージェント位置
+    std::vector<Vec2> velocities_;                          // エージェント速度（知覚ステージ用の連続コピー）
+    agent::ActionBatch action_batch_;                       // 行為選択のSoA作業領域
+    HazeBatch haze_batch_;                                  // Haze推定の連続配列（EMA: N、Haze: 144×N）
+    HazeBatch::Array prediction_errors_;                    // 予測誤差（Haze推定の入力、N）
+    agent::SelectionMode selection_mode_ = agent::SelectionMode::Gradient;  // 行為選択の方式
+    std::shared_ptr<const agent::CandidateLattice> lattice_ =
+        agent::CandidateLattice::standard();                 // 速度候補（候補サンプリング用）
     Scalar beta_;                                           // MB破れ強度
     int avg_neighbors_;                                     // 平均近傍数
 
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "eph_swarm/haze_batch.hpp"
+#include "eph_spm/spm_batch.hpp"
+
+using namespace eph;
+using namespace eph::swarm;
+
+namespace {
+
+// エージェントごとに異なるSPM（一様チャネルのエージェントを1つ含む）
+auto make_perception(size_t n) -> spm::SpmBatch {
+    spm::SpmBatch perception(n);
+    for (size_t i = 1; i < n; ++i) {
+        perception.agent(i).mutable_channel(ChannelID::R1) = Matrix12x12::Random().cwiseAbs();
+        perception.agent(i).mutable_channel(ChannelID::F4) = Matrix12x12::Random().cwiseAbs();
+        perception.agent(i).mutable_channel(ChannelID::F5) = Matrix12x12::Random().cwiseAbs();
+    }
+    return perception;
+}
+
+}  // namespace
+
+// === エージェント単位の推定との一致 ===
+
+TEST(HazeBatch, MatchesPerAgentEstimatorBitwise) {
+    constexpr size_t kAgents = HazeBatch::kBlock + 7;  // 複数ブロック + 端数
+    const spm::SpmBatch perception = make_perception(kAgents);
+    auto spm_for = [&perception](size_t i) { return perception.agent(i); };
+
+    HazeBatch batch;
+    batch.resize(kAgents);
+    std::vector<agent::HazeEstimator> references(kAgents, agent::HazeEstimator(1.0));
+
+    HazeBatch::Array errors(static_cast<Eigen::Index>(kAgents));
+    for (int step = 0; step < 3; ++step) {
+        errors.setRandom();
+        errors = errors.abs();
+        batch.estimate(spm_for, errors);
+
+        for (size_t i = 0; i < kAgents; ++i) {
+            const Matrix12x12 reference = references[i].estimate(perception.agent(i), errors(static_cast<Eigen::Index>(i)));
+            EXPECT_EQ(Matrix12x12(batch.haze(i)), reference) << "agent " << i << ", step " << step;
+            EXPECT_EQ(batch.ema_error(i), references[i].ema_error());
+        }
+    }
+}
+
+TEST(HazeBatch, WideBlurAndFastSigmoid_MatchPerAgentEstimator) {
+    constexpr size_t kAgents = 5;
+    const spm::SpmBatch perception = make_perception(kAgents);
+    auto spm_for = [&perception](size_t i) { return perception.agent(i); };
+
+    BasicHazeBatch<math::SigmoidMode::Fast> batch(2.0, 2.0);
+    batch.resize(kAgents);
+    agent::FastHazeEstimator reference(2.0, 2.0);
+
+    HazeBatch::Array errors = HazeBatch::Array::Constant(kAgents, 0.6);
+    batch.estimate(spm_for, errors);
+    EXPECT_EQ(Matrix12x12(batch.haze(3)), reference.estimate(perception.agent(3), 0.6));
+}
+
+// === 推定器との受け渡し ===
+
+TEST(HazeBatch, LoadStore_ContinuesPerAgentEma) {
+    const spm::SpmBatch perception = make_perception(2);
+    auto spm_for = [&perception](size_t i) { return perception.agent(i); };
+
+    // エージェント単位で2ステップ → バッチで1ステップ → 書き戻して単位で1ステップ
+    agent::HazeEstimator estimator(1.0);
+    agent::HazeEstimator reference(1.0);
+    for (Scalar error : {0.2, 0.7}) {
+        estimator.estimate(perception.agent(1), error);
+        reference.estimate(perception.agent(1), error);
+    }
+
+    HazeBatch batch;
+    batch.resize(2);
+    batch.load(1, estimator);
+    batch.estimate(spm_for, HazeBatch::Array::Constant(2, 0.4));
+    batch.store(1, estimator);
+    EXPECT_EQ(Matrix12x12(batch.haze(1)), reference.estimate(perception.agent(1), 0.4));
+
+    EXPECT_EQ(estimator.estimate(perception.agent(1), 0.9), reference.estimate(perception.agent(1), 0.9));
+
+    // 未初期化のエージェントは初回の予測誤差で初期化される
+    EXPECT_EQ(batch.ema_error(0), Scalar(0.4));
+}
+
+TEST(HazeBatch, Accepts_OnlyScalarEmaWithSameSettings) {
+    const spm::SpmBatch perception = make_perception(1);
+    HazeBatch batch;
+
+    EXPECT_TRUE(batch.accepts(agent::HazeEstimator(1.0)));
+    EXPECT_FALSE(batch.accepts(agent::HazeEstimator(2.0)));
+    EXPECT_FALSE(batch.accepts(agent::HazeEstimator(1.0, 2.0)));
+
+    // ビンごとのEMAフィールドを持つ推定器は受け渡せない
+    agent::HazeEstimator per_bin(1.0);
+    per_bin.estimate(perception.agent(0), Matrix12x12::Constant(0.3));
+    EXPECT_FALSE(batch.accepts(per_bin));
+}
+
+TEST(HazeBatch, Resize_NewAgentsStartUninitialized) {
+    HazeBatch batch;
+    batch.resize(3);
+    const spm::SpmBatch perception = make_perception(4);
+    auto spm_for = [&perception](size_t i) { return perception.agent(i); };
+    batch.estimate(spm_for, HazeBatch::Array::Constant(3, 0.5));
+
+    batch.resize(4);
+    EXPECT_EQ(batch.size(), 4);
+    EXPECT_EQ(Matrix12x12(batch.haze(3)), Matrix12x12::Zero());
+    batch.estimate(spm_for, HazeBatch::Array::Constant(4, 0.1));
+    EXPECT_EQ(batch.ema_error(3), Scalar(0.1));               // 初回は入力そのもの
+    EXPECT_EQ(batch.ema_error(0), agent::HazeEstimator(1.0).blend_ema(Scalar(0.5), Scalar(0.1)));
+}
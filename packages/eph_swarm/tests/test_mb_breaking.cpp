@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <cmath>
+#include <limits>
 #include "eph_swarm/swarm_manager.hpp"
 
 using namespace eph;
@@ -110,8 +111,8 @@ TEST(MBBreaking, TotalHaze_ConservationWithUniformNeighbors) {
         total_after += h.sum();
     }
 
-    // 総Hazeは保存される（均一な近傍構造の場合）
-    EXPECT_NEAR(total_after, total_before, 1e-8)
+    // 総Hazeは保存される（均一な近傍構造の場合、総和の丸め誤差まで）
+    EXPECT_NEAR(total_after, total_before, 8 * std::numeric_limits<Scalar>::epsilon() * total_before)
         << "Total haze should be conserved with uniform neighbors";
 }
 
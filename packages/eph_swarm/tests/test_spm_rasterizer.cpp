@@ -0,0 +1,231 @@
+/**
+ * @file test_spm_rasterizer.cpp
+ * @brief 自己中心SPMラスタライザ（F0/F1/F3知覚ステージ）のテスト
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "eph_swarm/spm_rasterizer.hpp"
+#include "eph_spm/polar_grid.hpp"
+
+using namespace eph;
+using namespace eph::swarm;
+
+namespace {
+
+// 丸め誤差の許容（Scalar の機械イプシロン基準。倍精度・単精度の両構成で実行）
+constexpr Scalar kEps = std::numeric_limits<Scalar>::epsilon();
+
+// 2エージェント: 自分（id=0）と近傍（id=1）を指定状態に配置
+SwarmManager make_pair_swarm(const Vec2& self_pos, const Vec2& self_vel,
+                             const Vec2& other_pos, const Vec2& other_vel) {
+    SwarmManager swarm(2, 0.0, 1);
+    swarm.set_agent_state(0, AgentState(self_pos, self_vel, 1.0, 0.0));
+    swarm.set_agent_state(1, AgentState(other_pos, other_vel, 1.0, 0.0));
+    return swarm;
+}
+
+}  // namespace
+
+// === ビン規約 ===
+
+TEST(PolarGrid, ThetaBin_FollowsFovConvention) {
+    const Scalar deg = constants::PI / 180.0;
+
+    // 270° FOV: bin 0 = [-135°, -105°), 正面 0° は bin 4 = [-15°, +15°)
+    EXPECT_EQ(spm::theta_bin(-134.0 * deg), 0);
+    EXPECT_EQ(spm::theta_bin(0.0), 4);
+    EXPECT_EQ(spm::theta_bin(134.0 * deg), 8);
+
+    // 後方（死角）: bin 9..11
+    EXPECT_EQ(spm::theta_bin(150.0 * deg), 9);
+    EXPECT_EQ(spm::theta_bin(180.0 * deg), 10);
+    EXPECT_EQ(spm::theta_bin(-140.0 * deg), 11);
+
+    // 周期性
+    EXPECT_EQ(spm::theta_bin(2.0 * constants::PI), spm::theta_bin(0.0));
+    EXPECT_EQ(spm::theta_bin(-4.0 * constants::PI + 10.0 * deg), spm::theta_bin(10.0 * deg));
+}
+
+TEST(PolarGrid, ThetaBinCenter_RoundTrips) {
+    for (int a = 0; a < constants::N_THETA; ++a) {
+        EXPECT_EQ(spm::theta_bin(spm::theta_bin_center(a)), a);
+    }
+}
+
+TEST(PolarGrid, RBin_LinearAndClamped) {
+    EXPECT_EQ(spm::r_bin(0.0, 3.0), 0);
+    EXPECT_EQ(spm::r_bin(1.0, 3.0), 4);
+    EXPECT_EQ(spm::r_bin(2.99, 3.0), 11);
+    EXPECT_EQ(spm::r_bin(5.0, 3.0), 11);
+}
+
+// === 半径内近傍検索 ===
+
+TEST(SpmRasterizer, FindNeighborsWithin_RespectsRadiusAndTorus) {
+    SwarmManager swarm(4, 0.0, 1);
+    swarm.set_agent_state(0, AgentState(Vec2(9.8, 0.0), Vec2(1.0, 0.0), 1.0, 0.0));
+    swarm.set_agent_state(1, AgentState(Vec2(-9.8, 0.0), Vec2::Zero(), 1.0, 0.0));  // 境界越しに 0.4m
+    swarm.set_agent_state(2, AgentState(Vec2(8.0, 0.0), Vec2::Zero(), 1.0, 0.0));   // 1.8m
+    swarm.set_agent_state(3, AgentState(Vec2(0.0, 0.0), Vec2::Zero(), 1.0, 0.0));   // 範囲外
+
+    SwarmManager::NeighborBuffer neighbors;
+    swarm.find_neighbors_within(0, 3.0, 8, neighbors);
+    const auto& hits = neighbors.hits;
+
+    // 距離は座標（|x| ≤ WORLD_MAX）の差なので座標の丸め誤差を含む
+    const double tol = 4 * kEps * constants::WORLD_MAX;
+    ASSERT_EQ(hits.size(), 2u);
+    EXPECT_EQ(hits[0].id, 1u);
+    EXPECT_NEAR(hits[0].distance, 0.4, tol);
+    EXPECT_NEAR(hits[0].offset.x(), 0.4, tol);  // 最短変位は +x 方向
+    EXPECT_EQ(hits[1].id, 2u);
+    EXPECT_NEAR(hits[1].distance, 1.8, tol);
+
+    // 件数上限: 近い順に切り詰め
+    swarm.find_neighbors_within(0, 3.0, 1, neighbors);
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].id, 1u);
+}
+
+// === チャネル値 ===
+
+TEST(SpmRasterizer, HeadOnNeighbor_FillsForwardBin) {
+    // 自分は +x へ 1m/s、静止した近傍が正面 1m
+    auto swarm = make_pair_swarm(Vec2(0.0, 0.0), Vec2(1.0, 0.0), Vec2(1.0, 0.0), Vec2::Zero());
+    SpmRasterizer rasterizer;
+    spm::SpmBatch perception;
+    rasterizer.rasterize(swarm, perception);
+
+    ASSERT_EQ(perception.size(), 2u);
+    const auto view = perception.agent(0);
+    const int a = spm::theta_bin(0.0);
+    const int b = spm::r_bin(1.0, constants::SPM_PERCEPTION_RADIUS);
+
+    // v_in = 1, cosθ = 1
+    const Scalar expected_f1 = std::tanh(1.0 / (1.0 + constants::MOTION_PRESSURE_EPS));
+    const Scalar ttc = 1.0 / (1.0 + constants::TTC_EPS);
+    const Scalar expected_f3 = 1.0 / (ttc + 1.0);
+
+    EXPECT_DOUBLE_EQ(view.channel(ChannelID::F0)(a, b), 1.0);
+    EXPECT_NEAR(view.channel(ChannelID::F1)(a, b), expected_f1, 4 * kEps);
+    EXPECT_NEAR(view.channel(ChannelID::F3)(a, b), expected_f3, 4 * kEps);
+
+    // 他のセルは空
+    EXPECT_DOUBLE_EQ(view.channel(ChannelID::F0).sum(), 1.0);
+    EXPECT_NEAR(view.channel(ChannelID::F1).sum(), expected_f1, 4 * kEps);
+}
+
+TEST(SpmRasterizer, BearingIsHeadingRelative) {
+    // 自分は +y へ進行、近傍はワールド +y 方向 → 自己中心では正面
+    auto swarm = make_pair_swarm(Vec2(0.0, 0.0), Vec2(0.0, 0.5), Vec2(0.0, 2.0), Vec2::Zero());
+    SpmRasterizer rasterizer;
+    spm::SpmBatch perception;
+    rasterizer.rasterize(swarm, perception);
+
+    const auto occupancy = perception.agent(0).channel(ChannelID::F0);
+    EXPECT_DOUBLE_EQ(occupancy(spm::theta_bin(0.0), spm::r_bin(2.0, constants::SPM_PERCEPTION_RADIUS)), 1.0);
+
+    // 近傍から見ると自分は真後ろ（近傍は静止 → x 軸基準で方位 -90°）
+    const auto other = perception.agent(1).channel(ChannelID::F0);
+    const Scalar deg = constants::PI / 180.0;
+    EXPECT_DOUBLE_EQ(other(spm::theta_bin(-90.0 * deg), spm::r_bin(2.0, constants::SPM_PERCEPTION_RADIUS)), 1.0);
+}
+
+TEST(SpmRasterizer, RecedingOrRearNeighbor_HasNoMotionPressure) {
+    // 真横から接近する近傍: 占有と TTC はあるが、max(0, cosθ) = 0 で F1 = 0
+    auto swarm = make_pair_swarm(Vec2(0.0, 0.0), Vec2(0.5, 0.0), Vec2(0.0, 1.0), Vec2(0.5, -1.0));
+    SpmRasterizer rasterizer;
+    spm::SpmBatch perception;
+    rasterizer.rasterize(swarm, perception);
+
+    const auto view = perception.agent(0);
+    EXPECT_DOUBLE_EQ(view.channel(ChannelID::F0).sum(), 1.0);
+    EXPECT_DOUBLE_EQ(view.channel(ChannelID::F1).sum(), 0.0);
+    EXPECT_GT(view.channel(ChannelID::F3).maxCoeff(), 0.0);
+
+    // 離れていく近傍: v_in = 0 → F1 = 0, F3 = 1 / (r/ε + 1)
+    auto receding = make_pair_swarm(Vec2(0.0, 0.0), Vec2(0.5, 0.0), Vec2(1.0, 0.0), Vec2(1.5, 0.0));
+    rasterizer.rasterize(receding, perception);
+    const auto rv = perception.agent(0);
+    EXPECT_DOUBLE_EQ(rv.channel(ChannelID::F1).sum(), 0.0);
+    EXPECT_NEAR(rv.channel(ChannelID::F3).maxCoeff(), 1.0 / (1.0 / constants::TTC_EPS + 1.0), 4 * kEps);
+}
+
+TEST(SpmRasterizer, NeighborInBlindSpot_IsNotPerceived) {
+    // 真後ろ（死角）の近傍は占有・TTC とも書かない
+    auto swarm = make_pair_swarm(Vec2(0.0, 0.0), Vec2(0.5, 0.0), Vec2(-1.0, 0.0), Vec2(1.5, 0.0));
+    SpmRasterizer rasterizer;
+    spm::SpmBatch perception;
+    rasterizer.rasterize(swarm, perception);
+
+    const auto view = perception.agent(0);
+    EXPECT_DOUBLE_EQ(view.channel(ChannelID::F0).sum(), 0.0);
+    EXPECT_DOUBLE_EQ(view.channel(ChannelID::F3).sum(), 0.0);
+
+    // 近傍側からは自分が正面に見える
+    EXPECT_DOUBLE_EQ(perception.agent(1).channel(ChannelID::F0).sum(), 1.0);
+}
+
+TEST(SpmRasterizer, LeavesOtherChannelsUntouched) {
+    auto swarm = make_pair_swarm(Vec2(0.0, 0.0), Vec2(1.0, 0.0), Vec2(1.0, 0.0), Vec2::Zero());
+    spm::SpmBatch perception(2);
+    perception.agent(0).set_channel(ChannelID::F2, Matrix12x12::Constant(0.7));
+    perception.agent(0).set_channel(ChannelID::F0, Matrix12x12::Constant(0.3));  // 前ステップの値
+
+    SpmRasterizer rasterizer;
+    rasterizer.rasterize(swarm, perception);
+
+    EXPECT_TRUE(perception.agent(0).channel(ChannelID::F2).isApproxToConstant(0.7));
+    EXPECT_DOUBLE_EQ(perception.agent(0).channel(ChannelID::F0).sum(), 1.0);  // 再生成される
+}
+
+TEST(SpmRasterizer, BatchMatchesPerAgentRasterization) {
+    SwarmManager swarm(200, 0.1, 6);
+    SpmRasterizer rasterizer;
+    spm::SpmBatch batch;
+    rasterizer.rasterize(swarm, batch);
+
+    spm::SpmBatch serial(swarm.size());
+    SwarmManager::NeighborBuffer neighbors;
+    for (size_t i = 0; i < swarm.size(); ++i) {
+        rasterizer.rasterize_agent(swarm, i, neighbors, serial.agent(i));
+    }
+
+    for (ChannelID id : {ChannelID::F0, ChannelID::F1, ChannelID::F3}) {
+        EXPECT_EQ(batch.channel_block(id), serial.channel_block(id));
+    }
+    // 値域
+    EXPECT_GE(batch.channel_block(ChannelID::F1).minCoeff(), 0.0);
+    EXPECT_LT(batch.channel_block(ChannelID::F1).maxCoeff(), 1.0);
+    EXPECT_LE(batch.channel_block(ChannelID::F3).maxCoeff(), 1.0);
+}
+
+TEST(SpmRasterizer, RequestedChannels_ProducesOnlyDependencyClosure) {
+    SwarmManager swarm(200, 0.1, 6);
+    SpmRasterizer rasterizer;
+    spm::SpmBatch full;
+    spm::SpmBatch requested(swarm.size());
+    requested.channel_block(ChannelID::F1).setConstant(0.5);
+    requested.channel_block(ChannelID::F3).setConstant(0.5);
+
+    constexpr auto kRead = agent::EPHAgent::kReadChannels;
+    static_assert(SpmRasterizer::Outputs<kRead>::kOccupancy);
+    static_assert(SpmRasterizer::Outputs<kRead>::kTemporal);
+    static_assert(!SpmRasterizer::Outputs<kRead>::kPressure);
+    static_assert(!SpmRasterizer::Outputs<kRead>::kTtc);
+
+    for (int frame = 0; frame < 3; ++frame) {
+        rasterizer.rasterize(swarm, full);
+        rasterizer.rasterize<kRead>(swarm, requested);
+    }
+
+    // F5 の依存（F0）と時間チャネルは全チャネル経路と一致、要求外は変更しない
+    for (ChannelID id : {ChannelID::F0, ChannelID::R0, ChannelID::F5}) {
+        EXPECT_EQ(requested.channel_block(id), full.channel_block(id));
+    }
+    EXPECT_TRUE(requested.channel_block(ChannelID::F1).isConstant(0.5));
+    EXPECT_TRUE(requested.channel_block(ChannelID::F3).isConstant(0.5));
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <cmath>
+#include <memory>
+#include <vector>
 #include "eph_swarm/swarm_manager.hpp"
 
 using namespace eph;
@@ -11,7 +13,7 @@ TEST(SwarmManager, Constructor_InitializesCorrectly) {
     SwarmManager swarm(10, 0.098, 6);
 
     EXPECT_EQ(swarm.size(), 10);
-    EXPECT_DOUBLE_EQ(swarm.get_beta(), 0.098);
+    EXPECT_DOUBLE_EQ(swarm.get_beta(), Scalar(0.098));
 }
 
 TEST(SwarmManager, Constructor_CreatesAgents) {
@@ -139,3 +141,186 @@ TEST(SwarmManager, FindNeighbors_WithLargeK_Clamps) {
     // k > N-1の場合、N-1個が返される
     EXPECT_EQ(neighbors.size(), 9);
 }
+
+// === エージェント個別SPM（SpmBatch）テスト ===
+
+TEST(SwarmManager, UpdateWithBatch_SameMapForAll_MatchesSharedMap) {
+    SwarmManager shared(8, 0.098, 4);
+    SwarmManager batched(8, 0.098, 4);
+
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+
+    spm::SpmBatch perception(batched.size());
+    for (size_t i = 0; i < perception.size(); ++i) {
+        perception.agent(i).assign(spm);
+    }
+
+    for (int t = 0; t < 10; ++t) {
+        shared.update_all_agents(spm, 0.1);
+        batched.update_all_agents(perception, 0.1);
+    }
+
+    for (size_t i = 0; i < shared.size(); ++i) {
+        EXPECT_EQ(shared.get_agent(i).state().position, batched.get_agent(i).state().position);
+        EXPECT_EQ(shared.get_agent(i).haze(), batched.get_agent(i).haze());
+        EXPECT_EQ(shared.get_agent(i).efe().total(), batched.get_agent(i).efe().total());
+    }
+}
+
+TEST(SwarmManager, UpdateAllAgents_RecordsSameEfeAsPerAgentUpdate) {
+    SwarmManager swarm(8, 0.0, 4);
+
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    spm.set_channel(ChannelID::R1, Matrix12x12::Random().cwiseAbs());
+
+    std::vector<agent::EPHAgent> references;
+    for (size_t i = 0; i < swarm.size(); ++i) {
+        references.push_back(swarm.get_agent(i));
+    }
+    swarm.update_all_agents(spm, 0.1);
+
+    // バッチ経路の EFE = エージェント単体の update() が記録する EFE
+    for (size_t i = 0; i < swarm.size(); ++i) {
+        agent::EPHAgent& reference = references[i];
+        reference.update(spm, 0.1);
+        EXPECT_EQ(swarm.get_agent(i).state().velocity, reference.state().velocity);
+        EXPECT_EQ(swarm.get_agent(i).efe().epistemic, reference.efe().epistemic);
+        EXPECT_EQ(swarm.get_agent(i).efe().pragmatic, reference.efe().pragmatic);
+    }
+}
+
+TEST(SwarmManager, UpdateAllAgents_BatchedHazeMatchesPerAgentUpdate) {
+    // β = 0 では h_eff = h なので、群のHazeバッチとエージェント単位の推定を直接比較できる
+    SwarmManager swarm(8, 0.0, 4);
+
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    spm.set_channel(ChannelID::R1, Matrix12x12::Random().cwiseAbs());
+
+    std::vector<agent::EPHAgent> references;
+    for (size_t i = 0; i < swarm.size(); ++i) {
+        references.push_back(swarm.get_agent(i));
+    }
+
+    // バッチ経路 2 ステップ → エージェント単位（直線探索）→ バッチ経路（EMAの受け渡し）
+    const agent::SelectionMode modes[] = {agent::SelectionMode::Gradient, agent::SelectionMode::Gradient,
+                                          agent::SelectionMode::LineSearch, agent::SelectionMode::Gradient};
+    for (agent::SelectionMode mode : modes) {
+        swarm.set_selection_mode(mode);
+        swarm.update_all_agents(spm, 0.1);
+        for (size_t i = 0; i < swarm.size(); ++i) {
+            references[i].set_selection_mode(mode);
+            references[i].update(spm, 0.1);
+            EXPECT_EQ(swarm.get_agent(i).haze(), references[i].haze());
+            EXPECT_EQ(swarm.get_agent(i).haze_estimator().ema_error(),
+                      references[i].haze_estimator().ema_error());
+            EXPECT_EQ(swarm.get_agent(i).state().fatigue, references[i].state().fatigue);
+        }
+    }
+}
+
+TEST(SwarmManager, UpdateAllAgents_PerBinEmaFieldKeepsPerAgentEstimate) {
+    // ビンごとのEMAフィールドを持つ推定器はバッチで扱えない → エージェント単位の推定
+    SwarmManager swarm(8, 0.0, 4);
+
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+    spm.set_channel(ChannelID::R1, Matrix12x12::Random().cwiseAbs());
+
+    Matrix12x12 errors = Matrix12x12::Zero();
+    errors.topRows<3>().setConstant(0.9);
+    swarm.get_agent(2).haze_estimator().estimate(spm, errors);
+
+    std::vector<agent::EPHAgent> references;
+    for (size_t i = 0; i < swarm.size(); ++i) {
+        references.push_back(swarm.get_agent(i));
+    }
+    for (int step = 0; step < 2; ++step) {
+        swarm.update_all_agents(spm, 0.1);
+        for (size_t i = 0; i < swarm.size(); ++i) {
+            references[i].update(spm, 0.1);
+            EXPECT_EQ(swarm.get_agent(i).haze(), references[i].haze());
+            EXPECT_EQ(swarm.get_agent(i).haze_estimator().ema_error(),
+                      references[i].haze_estimator().ema_error());
+        }
+    }
+    EXPECT_TRUE(swarm.get_agent(2).haze_estimator().has_ema_field());
+}
+
+TEST(SwarmManager, SetSelectionMode_SwitchesBetweenGradientAndSampling) {
+    SwarmManager swarm(8, 0.0, 4);
+    EXPECT_EQ(swarm.selection_mode(), agent::SelectionMode::Gradient);
+
+    auto lattice = std::make_shared<const agent::CandidateLattice>(8, 2);
+    swarm.set_selection_mode(agent::SelectionMode::Sampling, lattice);
+    EXPECT_EQ(swarm.get_agent(0).selection_mode(), agent::SelectionMode::Sampling);
+    EXPECT_EQ(&swarm.get_agent(0).candidate_lattice(), lattice.get());
+
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+
+    std::vector<agent::EPHAgent> references;
+    for (size_t i = 0; i < swarm.size(); ++i) {
+        references.push_back(swarm.get_agent(i));
+    }
+    swarm.update_all_agents(spm, 0.1);
+
+    // バッチ経路 = エージェント単体の候補サンプリング
+    for (size_t i = 0; i < swarm.size(); ++i) {
+        references[i].update(spm, 0.1);
+        EXPECT_EQ(swarm.get_agent(i).state().velocity, references[i].state().velocity);
+        EXPECT_EQ(swarm.get_agent(i).efe().pragmatic, references[i].efe().pragmatic);
+    }
+
+    swarm.set_selection_mode(agent::SelectionMode::Gradient);
+    EXPECT_EQ(swarm.get_agent(0).selection_mode(), agent::SelectionMode::Gradient);
+}
+
+TEST(SwarmManager, LineSearchMode_RecordsSolverStats) {
+    SwarmManager swarm(8, 0.0, 4);
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+
+    // 固定ステップ: 1エージェント1反復、G の評価なし
+    swarm.update_all_agents(spm, 0.1);
+    EXPECT_EQ(swarm.solver_stats().iterations, 8);
+    EXPECT_EQ(swarm.solver_stats().evaluations, 0);
+
+    agent::DescentOptions options;
+    options.max_iterations = 5;
+    swarm.set_descent_options(options);
+    swarm.set_selection_mode(agent::SelectionMode::LineSearch);
+    swarm.update_all_agents(spm, 0.1);
+
+    const agent::SolverStats stats = swarm.solver_stats();
+    EXPECT_LE(stats.iterations, 8 * options.max_iterations);
+    EXPECT_GT(stats.evaluations, 0);
+    for (size_t i = 0; i < swarm.size(); ++i) {
+        EXPECT_EQ(swarm.get_agent(i).descent_options().max_iterations, 5);
+    }
+}
+
+TEST(SwarmManager, AgentSelectionMode_OverridesSwarmModeOnBatchedPath) {
+    // 群は勾配降下のまま、1エージェントだけ候補サンプリングにする
+    SwarmManager swarm(8, 0.0, 4);
+    swarm.get_agent(3).set_selection_mode(agent::SelectionMode::Sampling);
+
+    spm::SaliencyPolarMap spm;
+    spm.set_channel(ChannelID::F2, Matrix12x12::Random());
+
+    std::vector<agent::EPHAgent> references;
+    for (size_t i = 0; i < swarm.size(); ++i) {
+        references.push_back(swarm.get_agent(i));
+    }
+    swarm.update_all_agents(spm, 0.1);
+
+    // 各エージェントは自分の方式で更新される（エージェント単体の update() と一致）
+    for (size_t i = 0; i < swarm.size(); ++i) {
+        references[i].update(spm, 0.1);
+        EXPECT_EQ(swarm.get_agent(i).state().velocity, references[i].state().velocity);
+        EXPECT_EQ(swarm.get_agent(i).haze(), references[i].haze());
+    }
+    EXPECT_EQ(swarm.get_agent(3).selection_mode(), agent::SelectionMode::Sampling);
+}
@@ -1,11 +1,17 @@
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <thread>
 #include <chrono>
 #include <numeric>
+#include <optional>
+#include <string>
 #include "udp_server.hpp"
 #include "eph_swarm/swarm_manager.hpp"
 #include "eph_phase/phase_analyzer.hpp"
-#include "eph_spm/saliency_polar_map.hpp"
+#include "eph_swarm/spm_rasterizer.hpp"
+#include "eph_spm/spm_batch.hpp"
+#include "eph_spm/spm_recording.hpp"
 
 using namespace eph;
 
@@ -33,8 +39,9 @@ int main(int argc, char** argv) {
     swarm::SwarmManager swarm(N_AGENTS, BETA, AVG_NEIGHBORS);
     phase::PhaseAnalyzer analyzer;
 
-    // Create simple SPM (all zeros for Phase 1)
-    spm::SaliencyPolarMap test_spm;
+    // Per-agent egocentric perception (channels rasterized from neighbors each step)
+    swarm::SpmRasterizer rasterizer;
+    spm::SpmBatch perception(N_AGENTS);
 
     std::cout << "Simulation initialized (N=" << N_AGENTS << ")" << std::endl;
     std::cout << "Starting simulation loop..." << std::endl;
@@ -44,6 +51,17 @@ int main(int argc, char** argv) {
     const Scalar dt = 0.1;
     const int SEND_INTERVAL = 10;  // Send every 10 steps
 
+    // Optional perception recording for offline agent-model studies (--record <path>)
+    std::optional<spm::SpmRecorder> recorder;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--record") {
+            // The server runs until it is killed and never reaches close(), so the
+            // header's frame count is committed periodically to keep the file readable
+            recorder.emplace(argv[i + 1], N_AGENTS, dt, SEND_INTERVAL);
+            std::cout << "Recording perception to " << argv[i + 1] << std::endl;
+        }
+    }
+
     // Playback control state (start paused, user must press Play)
     bool is_playing = false;
     double speed_multiplier = 1.0;
@@ -77,6 +95,29 @@ int main(int argc, char** argv) {
                 sleep_ms = static_cast<int>(dt * 1000 / speed_multiplier);
                 std::cout << "  Speed set to " << speed_multiplier << "x (sleep=" << sleep_ms << "ms)" << std::endl;
             }
+            else if (cmd_type == "set_selection_mode") {
+                // {"mode": "gradient" | "sampling" | "line_search", "directions": 16, "speeds": 4,
+                //  "max_iterations": 20}
+                const std::string mode = command.value().value("mode", "gradient");
+                if (mode == "line_search") {
+                    agent::DescentOptions options;
+                    options.max_iterations = std::max(1, command.value().value("max_iterations", 20));
+                    swarm.set_descent_options(options);
+                    swarm.set_selection_mode(agent::SelectionMode::LineSearch);
+                    std::cout << "  Action selection: line search (max_iterations="
+                              << options.max_iterations << ")" << std::endl;
+                } else if (mode == "sampling") {
+                    const int directions = std::max(1, command.value().value("directions", 16));
+                    const int speeds = std::max(1, command.value().value("speeds", 4));
+                    swarm.set_selection_mode(
+                        agent::SelectionMode::Sampling,
+                        std::make_shared<const agent::CandidateLattice>(directions, speeds));
+                    std::cout << "  Action selection: sampling (M=" << directions * speeds << ")" << std::endl;
+                } else {
+                    swarm.set_selection_mode(agent::SelectionMode::Gradient);
+                    std::cout << "  Action selection: gradient" << std::endl;
+                }
+            }
             else if (cmd_type == "set_parameters") {
                 auto params = command.value()["parameters"];
                 std::cout << "  Parameters: " << params.dump() << std::endl;
@@ -86,7 +127,14 @@ int main(int argc, char** argv) {
 
         // Update simulation (only if playing)
         if (is_playing) {
-            swarm.update_all_agents(test_spm, dt);
+            // Agents read only EPHAgent::kReadChannels; recordings keep every channel
+            if (recorder) {
+                rasterizer.rasterize(swarm, perception);
+                recorder->append_frame(perception);
+            } else {
+                rasterizer.rasterize<agent::EPHAgent::kReadChannels>(swarm, perception);
+            }
+            swarm.update_all_agents(perception, dt);
             timestep++;
         }
 
@@ -108,11 +156,16 @@ int main(int argc, char** argv) {
                 agent_data.y = static_cast<float>(agent_state.position.y());
                 agent_data.vx = static_cast<float>(agent_state.velocity.x());
                 agent_data.vy = static_cast<float>(agent_state.velocity.y());
-                agent_data.haze_mean = static_cast<float>(agent.haze().mean());
+                agent_data.haze_mean = static_cast<float>(spm::visible_mean(agent.haze()));
                 agent_data.fatigue = static_cast<float>(agent_state.fatigue);
-                agent_data.efe = 0.0f;  // TODO: Add EFE tracking
+                agent_data.efe = static_cast<float>(agent.efe().total());
 
                 packet.agents.push_back(agent_data);
+
+                udp::EfeTermsData efe_terms;
+                efe_terms.epistemic = static_cast<float>(agent.efe().epistemic);
+                efe_terms.pragmatic = static_cast<float>(agent.efe().pragmatic);
+                packet.efe_terms.push_back(efe_terms);
             }
 
             // Collect metrics
@@ -122,7 +175,7 @@ int main(int argc, char** argv) {
             // Calculate average haze
             Scalar avg_haze = 0.0;
             for (const auto& haze : haze_fields) {
-                avg_haze += haze.mean();
+                avg_haze += spm::visible_mean(haze);
             }
             avg_haze /= static_cast<Scalar>(haze_fields.size());
 
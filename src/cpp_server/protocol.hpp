@@ -14,6 +14,10 @@ namespace eph::udp {
 // Magic number for packet identification: 0xEFE20210 (EPH v2.1, 2021-0)
 constexpr uint32_t MAGIC_NUMBER = 0xEFE20210;
 
+// Magic number for packets with the EFE terms section: 0xEFE20211 (EPH v2.1, 2021-1)
+// Layout: header | agents | metrics | EFE terms (one EfeTermsData per agent)
+constexpr uint32_t MAGIC_NUMBER_EFE_TERMS = 0xEFE20211;
+
 /**
  * @brief Binary packet header (24 bytes)
  */
@@ -67,6 +71,18 @@ struct MetricsData {
 
 static_assert(sizeof(MetricsData) == 48, "MetricsData must be 48 bytes");
 
+/**
+ * @brief EFE components per agent (8 bytes per agent, same order as agents)
+ *
+ * AgentData::efe carries the total; this section carries its two terms.
+ */
+struct EfeTermsData {
+    float epistemic;        // Epistemic term (haze x saliency gradient)
+    float pragmatic;        // Pragmatic term (fatigue-weighted speed)
+} __attribute__((packed));
+
+static_assert(sizeof(EfeTermsData) == 8, "EfeTermsData must be 8 bytes");
+
 /**
  * @brief Complete state packet
  */
@@ -74,6 +90,7 @@ struct StatePacket {
     PacketHeader header;
     std::vector<AgentData> agents;
     MetricsData metrics;
+    std::vector<EfeTermsData> efe_terms;  // Optional: empty, or one entry per agent
 
     StatePacket() = default;
 };
@@ -94,11 +111,17 @@ inline uint32_t calculate_crc32(const uint8_t* data, size_t length) {
 
 /**
  * @brief Serialize StatePacket to binary buffer
+ *
+ * With efe_terms set (one entry per agent) the section is appended after the
+ * metrics and the header carries MAGIC_NUMBER_EFE_TERMS.
  */
 inline std::vector<uint8_t> serialize_state_packet(const StatePacket& packet) {
-    const size_t total_size = sizeof(PacketHeader) +
-                              packet.agents.size() * sizeof(AgentData) +
-                              sizeof(MetricsData);
+    const bool with_efe_terms = !packet.efe_terms.empty() &&
+                                packet.efe_terms.size() == packet.agents.size();
+    const size_t payload_size = packet.agents.size() * sizeof(AgentData) +
+                                sizeof(MetricsData) +
+                                (with_efe_terms ? packet.efe_terms.size() * sizeof(EfeTermsData) : 0);
+    const size_t total_size = sizeof(PacketHeader) + payload_size;
 
     std::vector<uint8_t> buffer(total_size);
     size_t offset = 0;
@@ -115,12 +138,22 @@ inline std::vector<uint8_t> serialize_state_packet(const StatePacket& packet) {
 
     // Copy metrics
     std::memcpy(buffer.data() + offset, &packet.metrics, sizeof(MetricsData));
+    offset += sizeof(MetricsData);
+
+    // Copy EFE terms
+    if (with_efe_terms) {
+        for (const auto& terms : packet.efe_terms) {
+            std::memcpy(buffer.data() + offset, &terms, sizeof(EfeTermsData));
+            offset += sizeof(EfeTermsData);
+        }
+    }
 
     // Calculate checksum and data_length of payload (after copying data to buffer)
     PacketHeader header_with_checksum = packet.header;
-    header_with_checksum.data_length = static_cast<uint32_t>(
-        packet.agents.size() * sizeof(AgentData) + sizeof(MetricsData)
-    );
+    if (with_efe_terms) {
+        header_with_checksum.magic_number = MAGIC_NUMBER_EFE_TERMS;
+    }
+    header_with_checksum.data_length = static_cast<uint32_t>(payload_size);
     header_with_checksum.checksum = calculate_crc32(
         buffer.data() + sizeof(PacketHeader),
         buffer.size() - sizeof(PacketHeader)
@@ -10,6 +10,10 @@ from typing import Optional, Dict, List, Any
 # Magic number: 0xEFE20210 (EPH v2.1, 2021-0)
 MAGIC_NUMBER = 0xEFE20210
 
+# Magic number for packets with the EFE terms section: 0xEFE20211 (EPH v2.1, 2021-1)
+# Layout: header | agents | metrics | EFE terms (one EfeTermsData per agent)
+MAGIC_NUMBER_EFE_TERMS = 0xEFE20211
+
 
 def calculate_crc32(data: bytes) -> int:
     """CRC32 checksum matching C++ implementation"""
@@ -87,6 +91,23 @@ class MetricsData:
         }
 
 
+class EfeTermsData:
+    """EFE components per agent (8 bytes per agent, same order as agents)"""
+    SIZE = 8
+    FORMAT = '<ff'  # 2 float32 (little-endian)
+
+    @staticmethod
+    def parse(data: bytes) -> Optional[Dict[str, float]]:
+        if len(data) < EfeTermsData.SIZE:
+            return None
+
+        values = struct.unpack(EfeTermsData.FORMAT, data[:EfeTermsData.SIZE])
+        return {
+            'efe_epistemic': values[0],
+            'efe_pragmatic': values[1]
+        }
+
+
 def deserialize_state_packet(data: bytes) -> Optional[Dict[str, Any]]:
     """
     Deserialize binary state packet from C++ server
@@ -95,19 +116,24 @@ def deserialize_state_packet(data: bytes) -> Optional[Dict[str, Any]]:
         data: Binary packet data
 
     Returns:
-        Dictionary with 'header', 'agents', 'metrics' or None if invalid
+        Dictionary with 'header', 'agents', 'metrics' or None if invalid.
+        Packets with the EFE terms section (MAGIC_NUMBER_EFE_TERMS) also add
+        'efe_epistemic' and 'efe_pragmatic' to each agent.
     """
     if len(data) < PacketHeader.SIZE:
         return None
 
     # Parse header
     header = PacketHeader.parse(data)
-    if header is None or header['magic_number'] != MAGIC_NUMBER:
+    if header is None or header['magic_number'] not in (MAGIC_NUMBER, MAGIC_NUMBER_EFE_TERMS):
         return None
+    with_efe_terms = header['magic_number'] == MAGIC_NUMBER_EFE_TERMS
 
     # Validate checksum
     num_agents = header['num_agents']
     expected_payload_size = num_agents * AgentData.SIZE + MetricsData.SIZE
+    if with_efe_terms:
+        expected_payload_size += num_agents * EfeTermsData.SIZE
     if header['data_length'] != expected_payload_size:
         return None  # Payload size mismatch
 
@@ -142,6 +168,17 @@ def deserialize_state_packet(data: bytes) -> Optional[Dict[str, Any]]:
     metrics = MetricsData.parse(data[offset:offset + MetricsData.SIZE])
     if metrics is None:
         return None
+    offset += MetricsData.SIZE
+
+    # Parse EFE terms
+    if with_efe_terms:
+        for agent in agents:
+            terms = EfeTermsData.parse(data[offset:offset + EfeTermsData.SIZE])
+            if terms is None:
+                return None
+
+            agent.update(terms)
+            offset += EfeTermsData.SIZE
 
     return {
         'header': header,
@@ -96,6 +96,8 @@ class GlobalViewWidget(QWidget):
             agents: List of agent dicts with keys:
                     'agent_id', 'x', 'y', 'vx', 'vy',
                     'haze_mean', 'fatigue', 'efe'
+                    (and 'efe_epistemic', 'efe_pragmatic' when the
+                    server sends the EFE terms section)
         """
         self.agents_data = agents
         if not agents:
@@ -2,9 +2,11 @@ import struct
 import pytest
 from gui.bridge.protocol import (
     MAGIC_NUMBER,
+    MAGIC_NUMBER_EFE_TERMS,
     PacketHeader,
     AgentData,
     MetricsData,
+    EfeTermsData,
     deserialize_state_packet,
     calculate_crc32
 )
@@ -92,6 +94,46 @@ def test_deserialize_valid_packet():
     assert pytest.approx(packet['metrics']['chi'], 0.001) == 2.145
 
 
+def test_efe_terms_data_size():
+    """EfeTermsData should be exactly 8 bytes"""
+    assert EfeTermsData.SIZE == 8
+
+
+def test_deserialize_packet_with_efe_terms():
+    """Should attach the EFE terms section to each agent"""
+    agent0_data = struct.pack('<HHfffffff', 0, 0, 1.0, 2.0, 0.5, 0.3, 0.4, 0.1, 1.25)
+    agent1_data = struct.pack('<HHfffffff', 1, 0, 3.0, 4.0, 0.2, 0.1, 0.5, 0.2, 1.5)
+    metrics_data = struct.pack('<dddddd', 0.034, 2.145, 0.098, 0.45, 0.55, 0.15)
+    efe_terms = struct.pack('<ff', 1.0, 0.25) + struct.pack('<ff', 1.25, 0.25)
+
+    payload = agent0_data + agent1_data + metrics_data + efe_terms
+    header_data = struct.pack(
+        '<IIIIII',
+        MAGIC_NUMBER_EFE_TERMS,
+        1,
+        100,
+        2,
+        2 * 32 + 48 + 2 * 8,   # data_length (2 agents + metrics + 2 EFE terms)
+        calculate_crc32(payload)
+    )
+
+    packet = deserialize_state_packet(header_data + payload)
+
+    assert packet is not None
+    assert packet['agents'][0]['efe_epistemic'] == 1.0
+    assert packet['agents'][0]['efe_pragmatic'] == 0.25
+    assert packet['agents'][1]['efe_epistemic'] == 1.25
+    assert packet['agents'][0]['efe'] == packet['agents'][0]['efe_epistemic'] + packet['agents'][0]['efe_pragmatic']
+    assert pytest.approx(packet['metrics']['phi'], 0.001) == 0.034
+
+    # Without the EFE terms section the data_length does not match
+    truncated_payload = agent0_data + agent1_data + metrics_data
+    truncated_header = struct.pack(
+        '<IIIIII', MAGIC_NUMBER_EFE_TERMS, 1, 100, 2, 2 * 32 + 48, calculate_crc32(truncated_payload)
+    )
+    assert deserialize_state_packet(truncated_header + truncated_payload) is None
+
+
 def test_deserialize_invalid_magic():
     """Should return None for invalid magic number"""
     bad_header = struct.pack('<IIIIII', 0xDEADBEEF, 0, 0, 0, 0, 0)